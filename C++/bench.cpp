@@ -0,0 +1,501 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#ifdef WIN64
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "secp256k1/SECP256k1.h"
+#include "secp256k1/Int.h"
+#include "secp256k1/IntGroup.h"
+#include "secp256k1/FieldElement.h"
+#include "secp256k1/FieldBatch.h"
+#include "secp256k1/Random.h"
+#include "hash/sha256.h"
+#include "hash/ripemd160.h"
+
+using namespace std;
+
+// Microbenchmark of the field, point and hash kernels and of the per-key pipeline.
+// Output is CSV on stdout, one line per kernel (batch is the lane width for
+// the *_batch hash kernels) :
+//   kernel,batch,ops,ns_per_op,cycles_per_op
+// cycles are TSC cycles (reference clock, not core clock under turbo).
+// usage : bench [min_seconds_per_kernel] [kernel_name_filter]
+
+static double min_time = 0.5;
+static const char *filter = NULL;
+static volatile uint64_t sink;
+
+// Run f (which does opsPerCall operations) until min_time is reached
+template<typename F> void run(const char *name, int batch, uint64_t opsPerCall, F f) {
+
+    if (filter != NULL && strstr(name, filter) == NULL)
+        return;
+
+    f(); // warm up
+
+    uint64_t nbCall = 1;
+    while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = __rdtsc();
+        for (uint64_t i = 0; i < nbCall; i++)
+            f();
+        uint64_t c1 = __rdtsc();
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (t >= min_time) {
+            double ops = (double)(nbCall * opsPerCall);
+            printf("%s,%d,%" PRIu64 ",%.2f,%.1f\n", name, batch, nbCall * opsPerCall, t * 1e9 / ops, (double)(c1 - c0) / ops);
+            fflush(stdout);
+            return;
+        }
+        nbCall = (t < min_time / 16) ? nbCall * 8 : nbCall * 2;
+    }
+
+}
+
+// Batch walk of hash_hunt_batch_add : the FieldBatch kernels of this CPU add
+// and subtract the batch points around the centre with one batch inversion,
+// then batched compressed hash160 of the AffinePoint buffer and compare
+static void bench_pipeline(Secp256K1 *secp256k1, int batchSize) {
+
+    int half = batchSize / 2;
+    const FieldBatchKernels *kernels = field_batch_kernels();
+
+    // (i+1)G, the last one is the jump batchSize*G
+    vector<Int> addKeys(half + 1);
+    vector<Point> addPoints(half + 1);
+    for (int i = 0; i < half; i++)
+        addKeys[i].SetInt32(i + 1);
+    addKeys[half].SetInt32(batchSize);
+    secp256k1->ComputePublicKeyBatch(addKeys.data(), half + 1, addPoints.data());
+    FieldBatch addX(half + 1), addY(half + 1);
+    for (int i = 0; i <= half; i++) {
+        addX.Set(i, &addPoints[i].x);
+        addY.Set(i, &addPoints[i].y);
+    }
+
+    FieldBatch deltaX(half + 1), prefix(half + 1);
+    FieldBatch plusX(half + 1), plusY(half + 1), minusX(half + 1), minusY(half + 1);
+    vector<AffinePoint> pointBatch(batchSize);
+    vector<unsigned char> hashBatch(20 * batchSize);
+    FieldElement startX, startY, ex, ey;
+    Int k;
+    Point startPoint;
+    unsigned char target[20];
+    memset(target, 0, 20);
+
+    k.SetBase16("8000000000000000000000000000000000000");
+    secp256k1->ComputePublicKey(&k, &startPoint);
+    startX.Set(&startPoint.x);
+    startY.Set(&startPoint.y);
+
+    run("pipeline_batch", batchSize, batchSize, [&]() {
+
+        kernels->AddPoints(&startX, &startY, &addX, &addY, half + 1, &deltaX, &prefix,
+                           &plusX, &plusY, &minusX, &minusY);
+
+        pointBatch[half].Set(&startX, &startY);
+        for (int i = 0; i < half; i++) {
+            if (i < half - 1) {
+                plusX.Get(i, &ex);
+                plusY.Get(i, &ey);
+                pointBatch[half + 1 + i].Set(&ex, &ey);
+            }
+            minusX.Get(i, &ex);
+            minusY.Get(i, &ey);
+            pointBatch[half - 1 - i].Set(&ex, &ey);
+        }
+
+        secp256k1->GetHash160Batch(pointBatch.data(), batchSize, true, hashBatch.data());
+        for (int i = 0; i < batchSize; i++) {
+            if (ripemd160_comp_hash(hashBatch.data() + 20 * i, target))
+                sink = sink + 1;
+        }
+
+        plusX.Get(half, &startX);
+        plusY.Get(half, &startY);
+
+    });
+
+}
+
+// The same walk on Int, IntGroup and Point, the batch loop before the
+// FieldBatch kernels
+static void bench_pipeline_int(Secp256K1 *secp256k1, int batchSize) {
+
+    int half = batchSize / 2;
+    vector<Point> addPoints(half);
+    addPoints[0] = secp256k1->G;
+    addPoints[1] = secp256k1->DoubleDirect(secp256k1->G);
+    for (int i = 2; i < half; i++)
+        addPoints[i] = secp256k1->AddPoints(addPoints[i - 1], secp256k1->G);
+    Point batchJump = secp256k1->DoubleDirect(addPoints[half - 1]);
+
+    IntGroup modGroup(half + 1);
+    vector<Int> deltaX(half + 1);
+    modGroup.Set(deltaX.data());
+    vector<Point> pointBatch(batchSize);
+    vector<unsigned char> hashBatch(20 * batchSize);
+    Int deltaY, slope, k;
+    Point startPoint, P;
+    unsigned char target[20];
+    memset(target, 0, 20);
+
+    k.SetBase16("8000000000000000000000000000000000000");
+    startPoint = secp256k1->ComputePublicKey(&k);
+
+    run("pipeline_batch_int", batchSize, batchSize, [&]() {
+
+        for (int i = 0; i < half; i++)
+            deltaX[i].ModSub(&startPoint.x, &addPoints[i].x);
+        deltaX[half].ModSub(&startPoint.x, &batchJump.x);
+
+        modGroup.ModInv();
+
+        pointBatch[half].x.Set(&startPoint.x);
+        pointBatch[half].y.Set(&startPoint.y);
+
+        for (int i = 0; i < half; i++) {
+
+            if (i < half - 1) {
+                Int &rx = pointBatch[half + 1 + i].x;
+                Int &ry = pointBatch[half + 1 + i].y;
+                deltaY.ModSub(&startPoint.y, &addPoints[i].y);
+                slope.ModMulK1(&deltaY, &deltaX[i]);
+                rx.ModSquareK1(&slope);
+                rx.ModSub(&rx, &startPoint.x);
+                rx.ModSub(&rx, &addPoints[i].x);
+                ry.ModSub(&startPoint.x, &rx);
+                ry.ModMulK1(&slope, &ry);
+                ry.ModSub(&ry, &startPoint.y);
+            }
+
+            Int &rx = pointBatch[half - 1 - i].x;
+            Int &ry = pointBatch[half - 1 - i].y;
+            deltaY.ModAdd(&startPoint.y, &addPoints[i].y);
+            slope.ModMulK1(&deltaY, &deltaX[i]);
+            rx.ModSquareK1(&slope);
+            rx.ModSub(&rx, &startPoint.x);
+            rx.ModSub(&rx, &addPoints[i].x);
+            ry.ModSub(&startPoint.x, &rx);
+            ry.ModMulK1(&slope, &ry);
+            ry.ModSub(&ry, &startPoint.y);
+
+        }
+
+        secp256k1->GetHash160Batch(pointBatch.data(), batchSize, true, hashBatch.data());
+        for (int i = 0; i < batchSize; i++) {
+            if (ripemd160_comp_hash(hashBatch.data() + 20 * i, target))
+                sink = sink + 1;
+        }
+
+        deltaY.ModSub(&startPoint.y, &batchJump.y);
+        slope.ModMulK1(&deltaY, &deltaX[half]);
+        P.x.ModSquareK1(&slope);
+        P.x.ModSub(&P.x, &startPoint.x);
+        P.x.ModSub(&P.x, &batchJump.x);
+        P.y.ModSub(&startPoint.x, &P.x);
+        P.y.ModMulK1(&slope, &P.y);
+        P.y.ModSub(&P.y, &startPoint.y);
+        startPoint.x.Set(&P.x);
+        startPoint.y.Set(&P.y);
+
+    });
+
+}
+
+auto main(int argc, char **argv) -> int {
+
+    if (argc > 1) min_time = atof(argv[1]);
+    if (argc > 2) filter = argv[2];
+
+    Secp256K1* secp256k1 = new Secp256K1(); secp256k1->Init();
+
+    printf("# compiler %s\n", __VERSION__);
+    printf("# sha_ni %d, sha256_33_batch lanes %d, ripemd160_32_batch lanes %d\n",
+           (int)sha256_shani(), sha256_33_lanes(), ripemd160_32_lanes());
+    printf("kernel,batch,ops,ns_per_op,cycles_per_op\n");
+
+    Int a, b, k;
+    a.SetBase16("79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798");
+    b.SetBase16("483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8");
+    k.SetBase16("8000000000000000000000000000000000000");
+
+    // Field
+    run("ModMulK1", 1, 1, [&]() { a.ModMulK1(&a, &b); });
+    run("ModSquareK1", 1, 1, [&]() { a.ModSquareK1(&a); });
+    if (Int::GetAdx()) {
+        Int::SetAdx(false);
+        run("ModMulK1_portable", 1, 1, [&]() { a.ModMulK1(&a, &b); });
+        run("ModSquareK1_portable", 1, 1, [&]() { a.ModSquareK1(&a); });
+        Int::SetAdx(true);
+    }
+    run("ModInv", 1, 1, [&]() { a.ModInv(); });
+    int modInv = Int::GetModInv();
+    for (int m = 0; m < MODINV_NB; m++) {
+        std::string name = std::string("ModInv_") + Int::GetModInvName(m);
+        Int::SetModInv(m);
+        run(name.c_str(), 1, 1, [&]() { a.ModInv(); });
+    }
+    Int::SetModInv(modInv);
+    run("ModSub", 1, 1, [&]() { a.ModSub(&a, &b); });
+    run("ModAdd", 1, 1, [&]() { a.ModAdd(&a, &b); });
+
+    FieldElement fa, fb;
+    fa.Set(&a);
+    fb.Set(&b);
+    run("FieldElement::Mul", 1, 1, [&]() { fa.Mul(&fa, &fb); });
+    run("FieldElement::Sqr", 1, 1, [&]() { fa.Sqr(&fa); });
+    run("FieldElement::Sub", 1, 1, [&]() { fa.Sub(&fa, &fb); });
+    run("FieldElement::Add", 1, 1, [&]() { fa.Add(&fa, &fb); });
+
+    // SoA kernels, per element of a batch of 512
+    {
+        const int size = 512;
+        FieldBatch ba(size), bb(size);
+        for (int i = 0; i < size; i++) {
+            ba.Set(i, &fa);
+            bb.Set(i, &fb);
+            fa.Mul(&fb);
+        }
+        for (const FieldBatchKernels *kernels : {&field_batch_scalar, &field_batch_avx2, &field_batch_avx512, &field_batch_ifma}) {
+            if (field_batch_kernels(kernels->name) == NULL)
+                continue;
+            std::string name = std::string("FieldBatch_") + kernels->name;
+            run((name + "::Mul").c_str(), size, size, [&]() { kernels->Mul(&ba, &ba, &bb, size); });
+            run((name + "::Sqr").c_str(), size, size, [&]() { kernels->Sqr(&ba, &ba, size); });
+            run((name + "::Sub").c_str(), size, size, [&]() { kernels->Sub(&ba, &ba, &bb, size); });
+        }
+    }
+
+    for (int size : {256, 512, 1024, 2048}) {
+        vector<Int> ints(size);
+        for (int i = 0; i < size; i++) {
+            ints[i].Set(&a);
+            a.ModMulK1(&b);
+        }
+        IntGroup group(size);
+        group.Set(ints.data());
+        run("IntGroup::ModInv", size, size, [&]() { group.ModInv(); });
+        IntGroup serial(size, 1);
+        serial.Set(ints.data());
+        run("IntGroup::ModInv_1chain", size, size, [&]() { serial.ModInv(); });
+        vector<FieldElement> elems(size);
+        for (int i = 0; i < size; i++)
+            elems[i].Set(&ints[i]);
+        FieldGroup fgroup(size);
+        fgroup.Set(elems.data());
+        run("FieldGroup::ModInv", size, size, [&]() { fgroup.ModInv(); });
+    }
+
+    // Affine P + Q once the inverse of x(Q) - x(P) is known, as in the batch loop
+    {
+        Point P = secp256k1->G, Q = secp256k1->DoubleDirect(secp256k1->G);
+        Int inv, deltaY, slope, rx, ry;
+        inv.ModSub(&Q.x, &P.x);
+        inv.ModInv();
+        run("AffineAdd_Int", 1, 1, [&]() {
+            deltaY.ModSub(&Q.y, &P.y);
+            slope.ModMulK1(&deltaY, &inv);
+            rx.ModSquareK1(&slope);
+            rx.ModSub(&rx, &P.x);
+            rx.ModSub(&rx, &Q.x);
+            ry.ModSub(&P.x, &rx);
+            ry.ModMulK1(&slope, &ry);
+            ry.ModSub(&ry, &P.y);
+            P.y.Set(&ry);
+        });
+        FieldElement px, py, qx, qy, finv, fdeltaY, fslope, frx, fry;
+        px.Set(&P.x);
+        py.Set(&P.y);
+        qx.Set(&Q.x);
+        qy.Set(&Q.y);
+        finv.Set(&inv);
+        run("AffineAdd_FieldElement", 1, 1, [&]() {
+            fdeltaY.Sub(&qy, &py);
+            fslope.Mul(&fdeltaY, &finv);
+            frx.Sqr(&fslope);
+            frx.Sub(&frx, &px);
+            frx.Sub(&frx, &qx);
+            fry.Sub(&px, &frx);
+            fry.Mul(&fslope, &fry);
+            fry.Sub(&fry, &py);
+            py.Set(&fry);
+        });
+        sink = fry.n[0] ^ ry.bits64[0];
+    }
+
+    // P +- Q[i] for the 513 add points of the batch loop, inversion included
+    {
+        const int size = 513;
+        vector<Int> keys(size);
+        vector<Point> points(size);
+        for (int i = 0; i < size; i++)
+            keys[i].SetInt32(i + 1);
+        secp256k1->ComputePublicKeyBatch(keys.data(), size, points.data());
+        FieldBatch ax(size), ay(size), dx(size), pre(size), px(size), py(size), mx(size), my(size);
+        for (int i = 0; i < size; i++) {
+            ax.Set(i, &points[i].x);
+            ay.Set(i, &points[i].y);
+        }
+        Point C = secp256k1->ComputePublicKey(&k);
+        FieldElement cx, cy;
+        cx.Set(&C.x);
+        cy.Set(&C.y);
+        for (const FieldBatchKernels *kernels : {&field_batch_scalar, &field_batch_avx2, &field_batch_avx512, &field_batch_ifma}) {
+            if (field_batch_kernels(kernels->name) == NULL)
+                continue;
+            std::string name = std::string("AddPoints_FieldBatch_") + kernels->name;
+            run(name.c_str(), size, 2 * size, [&]() {
+                kernels->AddPoints(&cx, &cy, &ax, &ay, size, &dx, &pre, &px, &py, &mx, &my);
+            });
+        }
+    }
+
+    // Point
+    Point P = secp256k1->ComputePublicKey(&k);
+    run("AddPoints", 1, 1, [&]() { P = secp256k1->AddPoints(P, secp256k1->G); });
+    run("AddPointsInto", 1, 1, [&]() { secp256k1->AddPointsInto(&P, P, secp256k1->G); });
+    run("ComputePublicKey", 1, 1, [&]() {
+        P = secp256k1->ComputePublicKey(&k);
+        k.AddOne();
+    });
+    run("ComputePublicKey_out", 1, 1, [&]() {
+        secp256k1->ComputePublicKey(&k, &P);
+        k.AddOne();
+    });
+    // One inversion for the batch, with the byte table then wider windows
+    {
+        const int size = 1024;
+        std::vector<Int> keys(size);
+        std::vector<Point> out(size);
+        rseed(1);
+        for (int i = 0; i < size; i++)
+            keys[i].Rand(256);
+        for (int w : {8, 12, 16}) {
+            std::string name = "ComputePublicKeyBatch_w" + std::to_string(w);
+            if (filter != NULL && strstr(name.c_str(), filter) == NULL)
+                continue;
+            secp256k1->SetGTableWindow(w);
+            run(name.c_str(), size, size, [&]() {
+                secp256k1->ComputePublicKeyBatch(keys.data(), size, out.data());
+                keys[0].AddOne();
+            });
+        }
+        secp256k1->SetGTableWindow(8);
+    }
+
+    // Hash, the output is fed back so calls are dependent
+    unsigned char buf[65], digest[32], hash160[20];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = 0x02;
+    // SHA-NI against the portable rounds, then the multi-lane batch where
+    // lane width 1 is the one-key path (SHA-NI when the host has it)
+    bool shaNi = sha256_shani();
+    for (int ni : {1, 0}) {
+        if (ni && !shaNi)
+            continue;
+        sha256_set_shani(ni);
+        run(ni ? "sha256_33_shani" : "sha256_33", 1, 1, [&]() {
+            sha256_33(buf, digest);
+            memcpy(buf + 1, digest, 32);
+        });
+        run(ni ? "sha256_65_shani" : "sha256_65", 1, 1, [&]() {
+            sha256_65(buf, digest);
+            memcpy(buf + 1, digest, 32);
+        });
+        run(ni ? "sha256_checksum_shani" : "sha256_checksum", 1, 1, [&]() {
+            sha256_checksum(buf, 25, digest);
+            buf[1] ^= digest[0];
+        });
+    }
+    sha256_set_shani(shaNi);
+    {
+        // 1024 keys per call like the batch loop, for each lane width
+        vector<uint8_t> keys(33 * 1024), digests(32 * 1024);
+        for (size_t i = 0; i < keys.size(); i++)
+            keys[i] = (uint8_t)(i * 131 + 7);
+        int lanes = sha256_33_lanes();
+        for (int l : {1, 4, 8, 16}) {
+            if (!sha256_33_set_lanes(l))
+                continue;
+            run("sha256_33_batch", l, 1024, [&]() {
+                sha256_33_batch(keys.data(), 1024, digests.data());
+                keys[0] ^= digests[0];
+            });
+        }
+        sha256_33_set_lanes(lanes);
+    }
+    run("ripemd160_32", 1, 1, [&]() {
+        ripemd160_32(digest, hash160);
+        memcpy(digest, hash160, 20);
+    });
+    {
+        vector<uint8_t> digests(32 * 1024), hashes(20 * 1024);
+        for (size_t i = 0; i < digests.size(); i++)
+            digests[i] = (uint8_t)(i * 131 + 7);
+        int lanes = ripemd160_32_lanes();
+        for (int l : {1, 4, 8, 16}) {
+            if (!ripemd160_32_set_lanes(l))
+                continue;
+            run("ripemd160_32_batch", l, 1024, [&]() {
+                ripemd160_32_batch(digests.data(), 1024, hashes.data());
+                digests[0] ^= hashes[0];
+            });
+        }
+        ripemd160_32_set_lanes(lanes);
+    }
+    run("GetHash160", 1, 1, [&]() {
+        secp256k1->GetHash160(0, true, P, hash160);
+        P.x.bits64[0] ^= *(uint64_t *)hash160;
+    });
+
+    {
+        vector<Point> points(1024);
+        vector<unsigned char> hashes(20 * 1024);
+        points[0] = P;
+        for (int i = 1; i < 1024; i++)
+            points[i] = secp256k1->AddPoints(points[i - 1], secp256k1->G);
+        run("GetHash160Batch", 1024, 1024, [&]() {
+            secp256k1->GetHash160Batch(points.data(), 1024, true, hashes.data());
+            points[0].x.bits64[0] ^= hashes[0];
+        });
+        run("GetHash160Batch_uncompressed", 1024, 1024, [&]() {
+            secp256k1->GetHash160Batch(points.data(), 1024, false, hashes.data());
+            points[0].x.bits64[0] ^= hashes[0];
+        });
+        vector<AffinePoint> affine(1024);
+        for (int i = 0; i < 1024; i++)
+            affine[i].Set(&points[i]);
+        run("GetHash160Batch_affine", 1024, 1024, [&]() {
+            secp256k1->GetHash160Batch(affine.data(), 1024, true, hashes.data());
+            affine[0].x[0] ^= hashes[0];
+        });
+    }
+
+    // Per-key pipeline, one-key hashing on the sequential walk then the batch walk of hash_hunt_batch_add
+    unsigned char target[20];
+    memset(target, 0, 20);
+    P = secp256k1->ComputePublicKey(&k);
+    run("pipeline_seq", 1, 1, [&]() {
+        secp256k1->GetHash160(0, true, P, hash160);
+        if (ripemd160_comp_hash(hash160, target))
+            sink = sink + 1;
+        P = secp256k1->AddPoints(P, secp256k1->G);
+    });
+    for (int size : {256, 512, 1024, 2048, 4096})
+        bench_pipeline(secp256k1, size);
+    for (int size : {256, 1024})
+        bench_pipeline_int(secp256k1, size);
+
+    sink = sink + a.bits64[0] + P.x.bits64[0] + hash160[0];
+    return 0;
+}
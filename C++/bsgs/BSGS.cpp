@@ -0,0 +1,386 @@
+#include "BSGS.h"
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../secp256k1/IntGroup.h"
+
+BSGS::BSGS(Secp256K1 *secp, std::vector<Point> &targets) {
+  this->secp = secp;
+  this->targets = targets;
+  table = NULL;
+  tableSize = 0;
+  nbBaby = 0;
+  giantStep = 0;
+  nbChain = 1;
+  chainSteps = 1;
+}
+
+BSGS::~BSGS() {
+  free(table);
+}
+
+uint64_t BSGS::GetGiantStep() {
+  return giantStep;
+}
+
+uint64_t BSGS::GetNbBaby() {
+  return nbBaby;
+}
+
+uint64_t BSGS::GetTableSize() {
+  return tableSize * sizeof(uint64_t);
+}
+
+void BSGS::GetChunkSize(Int *chunkSize) {
+  chunkSize->SetInt64(giantStep);
+  chunkSize->Mult((uint64_t)nbChain * chainSteps);
+}
+
+// Linear probing, slots are only written during the build and an empty
+// slot is 0 since i >= 1
+void BSGS::Insert(uint64_t x0, uint32_t i) {
+
+  uint64_t e = (x0 & 0xFFFFFFFF00000000ULL) | i;
+  uint64_t p = GetSlot(x0);
+  while (true) {
+    uint64_t empty = 0;
+    if (__atomic_compare_exchange_n(table + p, &empty, e, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      return;
+    if (++p == tableSize)
+      p = 0;
+  }
+
+}
+
+// x(iG) for i in [lo,hi), batches of BSGS_BABY_BATCH additions of jG to the
+// last point, one inversion per batch. Only the last y of a batch is needed.
+void BSGS::BuildRange(uint64_t lo, uint64_t hi) {
+
+  Int k;
+  Point P;
+
+  // The first points would add jG to jG, they are computed one by one
+  for (; lo < hi && lo <= BSGS_BABY_BATCH + 1; lo++) {
+    k.SetInt64(lo);
+    secp->ComputePublicKey(&k, &P);
+    Insert(P.x.bits64[0], (uint32_t)lo);
+  }
+  if (lo >= hi)
+    return;
+
+  // jG for j in [1,BSGS_BABY_BATCH], one cache line each
+  AffinePoint addPoints[BSGS_BABY_BATCH];
+  Point A = secp->G;
+  addPoints[0].Set(&A);
+  secp->DoubleDirectInto(&A, secp->G);
+  addPoints[1].Set(&A);
+  for (int j = 2; j < BSGS_BABY_BATCH; j++) {
+    secp->AddPointsInto(&A, A, secp->G);
+    addPoints[j].Set(&A);
+  }
+
+  IntGroup modGroup(BSGS_BABY_BATCH);
+  Int deltaX[BSGS_BABY_BATCH];
+  modGroup.Set(deltaX);
+  Int deltaY, slope, rx, ry, ax, ay;
+
+  // P = (lo-1)G, the batch covers lo..lo+n-1
+  k.SetInt64(lo - 1);
+  secp->ComputePublicKey(&k, &P);
+
+  while (lo < hi) {
+
+    int n = (hi - lo < BSGS_BABY_BATCH) ? (int)(hi - lo) : BSGS_BABY_BATCH;
+    for (int j = 0; j < n; j++) {
+      addPoints[j].GetX(&ax);
+      deltaX[j].ModSub(&ax, &P.x);
+    }
+    for (int j = n; j < BSGS_BABY_BATCH; j++)
+      deltaX[j].SetInt32(1);
+
+    modGroup.ModInv();
+
+    for (int j = 0; j < n; j++) {
+      addPoints[j].GetX(&ax);
+      addPoints[j].GetY(&ay);
+      deltaY.ModSub(&ay, &P.y);
+      slope.ModMulK1(&deltaY, &deltaX[j]);
+      rx.ModSquareK1(&slope);
+      rx.ModSub(&rx, &P.x);
+      rx.ModSub(&rx, &ax);
+      Insert(rx.bits64[0], (uint32_t)(lo + j));
+      if (j == n - 1) {
+        ry.ModSub(&P.x, &rx);
+        ry.ModMulK1(&slope, &ry);
+        ry.ModSub(&ry, &P.y);
+        P.x.Set(&rx);
+        P.y.Set(&ry);
+      }
+    }
+
+    lo += n;
+
+  }
+
+}
+
+void BSGS::Build(uint64_t memory, Int *rangeWidth, int nbThread) {
+
+  // m <= (width+1)/2, one giant step then covers the whole range
+  Int half(rangeWidth);
+  half.AddOne();
+  half.ShiftR(1);
+  uint64_t maxBaby = (half.GetBitLength() > 32) ? 0xFFFFFFFFULL : half.bits64[0];
+  // The 2m+1 keys of a giant step cost m baby steps once and one step per
+  // target, the work balances at m = sqrt(targets * width / 2). The memory
+  // budget stays the upper bound.
+  double balance = sqrt((double)targets.size() * rangeWidth->ToDouble() / 2.0) + 1.0;
+  if (balance < (double)maxBaby)
+    maxBaby = (uint64_t)balance;
+
+  uint64_t nbSlot = memory / sizeof(uint64_t);
+  if (nbSlot > 0xFFFFFFFFULL)
+    nbSlot = 0xFFFFFFFFULL;
+  nbBaby = nbSlot / BSGS_LOAD_DEN * BSGS_LOAD_NUM;
+  if (nbBaby > maxBaby)
+    nbBaby = maxBaby;
+  if (nbBaby < 1)
+    nbBaby = 1;
+  tableSize = nbBaby / BSGS_LOAD_NUM * BSGS_LOAD_DEN + BSGS_LOAD_DEN;
+  if (tableSize > 0xFFFFFFFFULL)
+    tableSize = 0xFFFFFFFFULL;
+
+  giantStep = 2 * nbBaby + 1;
+  Int s;
+  s.SetInt64(giantStep);
+  secp->ComputePublicKey(&s, &giantPoint);
+
+  table = (uint64_t *)aligned_alloc(64, (tableSize * sizeof(uint64_t) + 63) / 64 * 64);
+  memset(table, 0, tableSize * sizeof(uint64_t));
+
+  // Baby steps split over the threads
+  std::vector<std::thread> threads(nbThread);
+  uint64_t per = nbBaby / nbThread + 1;
+  for (int t = 0; t < nbThread; t++) {
+    uint64_t lo = 1 + per * t;
+    uint64_t hi = lo + per;
+    if (hi > nbBaby + 1) hi = nbBaby + 1;
+    threads[t] = std::thread([this, lo, hi]() {
+      if (lo < hi) BuildRange(lo, hi);
+    });
+  }
+  for (int t = 0; t < nbThread; t++)
+    threads[t].join();
+
+  // Chains per target to fill one inversion, giant steps per chain so that
+  // every thread gets several chunks
+  int nbTarget = (int)targets.size();
+  nbChain = BSGS_GROUP_SIZE / nbTarget;
+  if (nbChain < 1)
+    nbChain = 1;
+  Int nbGiant(rangeWidth), r;
+  nbGiant.Div(&s, &r);
+  if (!r.IsZero())
+    nbGiant.AddOne();
+  chainSteps = BSGS_CHAIN_STEPS;
+  if (nbGiant.GetBitLength() <= 48) {
+    uint64_t J = nbGiant.bits64[0];
+    uint64_t perThread = (J + nbThread - 1) / nbThread;
+    if ((uint64_t)nbChain > perThread)
+      nbChain = (int)perThread;
+    chainSteps = perThread / ((uint64_t)nbChain * 8);
+    if (chainSteps < 1)
+      chainSteps = 1;
+    if (chainSteps > BSGS_CHAIN_STEPS)
+      chainSteps = BSGS_CHAIN_STEPS;
+  }
+
+}
+
+// Candidates for D = Q - cG, the key is c+i or c-i when x(D) = x(iG)
+void BSGS::Check(int target, Int *centre, Point &D, FoundCallback &found) {
+
+  uint64_t x0 = D.x.bits64[0];
+  uint64_t fp = x0 >> 32;
+  uint64_t p = GetSlot(x0);
+  Point &Q = targets[target];
+
+  while (table[p] != 0) {
+    if ((table[p] >> 32) == fp) {
+      Int i;
+      i.SetInt64(table[p] & 0xFFFFFFFFULL);
+      for (int sign = 0; sign < 2; sign++) {
+        Int k(centre);
+        if (sign) k.Sub(&i); else k.Add(&i);
+        Point P;
+        secp->ComputePublicKey(&k, &P);
+        if (P.x.IsEqual(&Q.x) && P.y.IsEqual(&Q.y)) {
+          found(k, target);
+          return;
+        }
+      }
+    }
+    if (++p == tableSize)
+      p = 0;
+  }
+
+}
+
+// D = Q - cG, Q = cG is reported here
+void BSGS::StartChain(int target, Int *centre, Point &D, FoundCallback &found) {
+
+  Point &Q = targets[target];
+  Point C;
+  secp->ComputePublicKey(centre, &C);
+  if (C.x.IsEqual(&Q.x)) {
+    if (C.y.IsEqual(&Q.y)) {
+      Int k(centre);
+      found(k, target);
+      // Any point, the chain goes on with candidates that fail the check
+      D = Q;
+      return;
+    }
+    // Q = -cG
+    secp->DoubleDirectInto(&D, Q);
+    return;
+  }
+  C.y.ModNeg();
+  secp->AddPointsInto(&D, Q, C);
+
+}
+
+void BSGS::Search(int thread, Scheduler *scheduler, Reporter *reporter, FoundCallback found) {
+
+  int nbTarget = (int)targets.size();
+  int groupSize = nbChain * nbTarget;
+
+  std::vector<Point> D(groupSize);
+  std::vector<Int> deltaX(groupSize);
+  std::vector<bool> restart(groupSize);
+  IntGroup modGroup(groupSize);
+  modGroup.Set(deltaX.data());
+  std::vector<Int> centres(nbChain);
+  std::vector<Point> C(nbChain);
+  Int deltaY, slope, rx, ry;
+
+  Int start, length, centre, offset, chainLength, end;
+  chainLength.SetInt64(giantStep);
+  chainLength.Mult(chainSteps);
+  uint64_t count = 0;
+
+  while (scheduler->NextChunk(thread, &start, &length)) {
+
+    // Chain t covers the centres start + m + (t*chainSteps + u)*s, u < chainSteps
+    for (int t = 0; t < nbChain; t++) {
+      centres[t].Set(&start);
+      centres[t].Add(nbBaby);
+      offset.Set(&chainLength);
+      offset.Mult((uint64_t)t);
+      centres[t].Add(&offset);
+    }
+
+    // First centres cG with one inversion, then D = Q - cG with one more.
+    // x(Q) = x(cG) goes through StartChain.
+    secp->ComputePublicKeyBatch(centres.data(), nbChain, C.data());
+    for (int g = 0; g < groupSize; g++) {
+      deltaX[g].ModSub(&targets[g / nbChain].x, &C[g % nbChain].x);
+      restart[g] = deltaX[g].IsZero();
+      if (restart[g])
+        deltaX[g].SetInt32(1);
+    }
+
+    modGroup.ModInv();
+
+    for (int g = 0; g < groupSize; g++) {
+      int q = g / nbChain, t = g % nbChain;
+      if (restart[g]) {
+        StartChain(q, &centres[t], D[g], found);
+        continue;
+      }
+      Point &Q = targets[q];
+      deltaY.ModAdd(&Q.y, &C[t].y);
+      slope.ModMulK1(&deltaY, &deltaX[g]);
+      rx.ModSquareK1(&slope);
+      rx.ModSub(&rx, &Q.x);
+      rx.ModSub(&rx, &C[t].x);
+      ry.ModSub(&Q.x, &rx);
+      ry.ModMulK1(&slope, &ry);
+      ry.ModSub(&ry, &Q.y);
+      D[g].x.Set(&rx);
+      D[g].y.Set(&ry);
+      D[g].z.SetInt32(1);
+    }
+
+    for (uint64_t u = 0; u < chainSteps; u++) {
+
+      // Prefetch the slots of the round then look them up
+      for (int g = 0; g < groupSize; g++)
+        __builtin_prefetch(table + GetSlot(D[g].x.bits64[0]));
+      for (int g = 0; g < groupSize; g++) {
+        int q = g / nbChain, t = g % nbChain;
+        uint64_t p = GetSlot(D[g].x.bits64[0]);
+        uint64_t fp = D[g].x.bits64[0] >> 32;
+        // Most lookups end on the first empty slot, the full check is out of line
+        while (table[p] != 0 && (table[p] >> 32) != fp)
+          if (++p == tableSize) p = 0;
+        if (table[p] != 0) {
+          centre.Set(&start);
+          centre.Add(nbBaby);
+          offset.SetInt64(giantStep);
+          offset.Mult((uint64_t)t * chainSteps + u);
+          centre.Add(&offset);
+          Check(q, &centre, D[g], found);
+        }
+      }
+
+      count += nbChain;
+      reporter->SetKeys(thread, count);
+
+      if (u == chainSteps - 1)
+        break;
+
+      // D = D - sG for all chains. x(D) = x(sG) means the next centre is
+      // +-(key), these chains are restarted from scratch after the round.
+      for (int g = 0; g < groupSize; g++) {
+        deltaX[g].ModSub(&D[g].x, &giantPoint.x);
+        restart[g] = deltaX[g].IsZero();
+        if (restart[g])
+          deltaX[g].SetInt32(1);
+      }
+
+      modGroup.ModInv();
+
+      for (int g = 0; g < groupSize; g++) {
+        deltaY.ModAdd(&D[g].y, &giantPoint.y);
+        slope.ModMulK1(&deltaY, &deltaX[g]);
+        rx.ModSquareK1(&slope);
+        rx.ModSub(&rx, &D[g].x);
+        rx.ModSub(&rx, &giantPoint.x);
+        ry.ModSub(&D[g].x, &rx);
+        ry.ModMulK1(&slope, &ry);
+        ry.ModSub(&ry, &D[g].y);
+        D[g].x.Set(&rx);
+        D[g].y.Set(&ry);
+      }
+
+      for (int g = 0; g < groupSize; g++) {
+        if (!restart[g])
+          continue;
+        int q = g / nbChain, t = g % nbChain;
+        centre.Set(&start);
+        centre.Add(nbBaby);
+        offset.SetInt64(giantStep);
+        offset.Mult((uint64_t)t * chainSteps + u + 1);
+        centre.Add(&offset);
+        StartChain(q, &centre, D[g], found);
+      }
+
+    }
+
+    end.Add(&start, &length);
+    scheduler->Progress(thread, &end);
+
+  }
+
+}
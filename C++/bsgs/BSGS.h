@@ -0,0 +1,74 @@
+#ifndef BSGSH
+#define BSGSH
+
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include "../secp256k1/SECP256k1.h"
+#include "../util/Scheduler.h"
+#include "../util/Reporter.h"
+
+#define BSGS_BABY_BATCH  1024  // Baby steps per batch inversion
+#define BSGS_GROUP_SIZE  1024  // Giant steps per batch inversion, all targets
+#define BSGS_CHAIN_STEPS 1024  // Max giant steps of a chain in one chunk
+#define BSGS_LOAD_NUM    3     // Baby step table load factor 3/4
+#define BSGS_LOAD_DEN    4
+
+// Baby-step giant-step search of known public keys.
+// The baby step table holds x(iG) for i in [1,m]. A slot is the high 32 bits
+// of the first x limb (fingerprint) and i, the slot index comes from the low
+// 32 bits. Giant steps of s = 2m+1 keys walk centres c, Q - cG = dG with
+// |d| <= m is found by its x since x(dG) = x(-dG). Every candidate is checked
+// with ComputePublicKey so fingerprint collisions are never reported.
+// A worker walks several chains per target to share one batch inversion per
+// round, a scheduler chunk is a whole number of rounds of all chains.
+class BSGS {
+
+public:
+
+  typedef std::function<void(Int &key, int target)> FoundCallback;
+
+  BSGS(Secp256K1 *secp, std::vector<Point> &targets);
+  ~BSGS();
+
+  // Allocate at most memory bytes for the table and fill it, m is limited
+  // to what covers the range in one giant step
+  void Build(uint64_t memory, Int *rangeWidth, int nbThread);
+  // Keys of a scheduler chunk
+  void GetChunkSize(Int *chunkSize);
+  // Keys covered by one giant step, the unit of the reporter counters
+  uint64_t GetGiantStep();
+  uint64_t GetNbBaby();
+  uint64_t GetTableSize();
+
+  // Worker loop, scans the chunks of the scheduler until the range is done
+  void Search(int thread, Scheduler *scheduler, Reporter *reporter, FoundCallback found);
+
+private:
+
+  void Insert(uint64_t x0, uint32_t i);
+  void BuildRange(uint64_t lo, uint64_t hi);
+  void Check(int target, Int *centre, Point &D, FoundCallback &found);
+  void StartChain(int target, Int *centre, Point &D, FoundCallback &found);
+
+  inline uint64_t GetSlot(uint64_t x0);
+
+  Secp256K1 *secp;
+  std::vector<Point> targets;
+
+  uint64_t *table;
+  uint64_t tableSize;
+  uint64_t nbBaby;         // m
+  uint64_t giantStep;      // s = 2m+1
+  Point giantPoint;        // sG
+  int nbChain;             // Chains per target
+  uint64_t chainSteps;     // Giant steps per chain and chunk
+
+};
+
+// Slot from the low 32 bits of x, tableSize < 2^32
+inline uint64_t BSGS::GetSlot(uint64_t x0) {
+  return ((x0 & 0xFFFFFFFFULL) * tableSize) >> 32;
+}
+
+#endif // BSGSH
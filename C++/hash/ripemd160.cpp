@@ -17,6 +17,8 @@
 
 #include "ripemd160.h"
 #include <string.h>
+#include <atomic>
+#include "../util/Cpu.h"
 
 /// Internal RIPEMD-160 implementation.
 namespace _ripemd160 {
@@ -297,6 +299,56 @@ void ripemd160_32(unsigned char *input, unsigned char *digest) {
 
 }
 
+// 0 until resolved, read and set from any thread
+static std::atomic<int> batchLanes(0);
+
+int ripemd160_32_lanes() {
+  int lanes = batchLanes;
+  if (lanes == 0) {
+    const CpuFeatures &cpu = cpu_features();
+    int best = cpu.avx512f ? 16 : (cpu.avx2 ? 8 : 4);
+    // A width set meanwhile by ripemd160_32_set_lanes is kept
+    if (batchLanes.compare_exchange_strong(lanes, best))
+      lanes = best;
+  }
+  return lanes;
+}
+
+bool ripemd160_32_set_lanes(int lanes) {
+  const CpuFeatures &cpu = cpu_features();
+  if ((lanes == 16 && !cpu.avx512f) || (lanes == 8 && !cpu.avx2) ||
+      (lanes != 1 && lanes != 4 && lanes != 8 && lanes != 16))
+    return false;
+  batchLanes = lanes;
+  return true;
+}
+
+void ripemd160_32_batch(uint8_t *input, int n, uint8_t *digest) {
+
+  int lanes = ripemd160_32_lanes();
+  int i = 0;
+
+  if (lanes == 16) {
+    for (; i + 16 <= n; i += 16)
+      ripemd160_32_x16(input + 32 * i, digest + 20 * i);
+  } else if (lanes == 8) {
+    for (; i + 8 <= n; i += 8)
+      ripemd160_32_x8(input + 32 * i, digest + 20 * i);
+  }
+  if (lanes > 1) {
+    for (; i + 4 <= n; i += 4)
+      ripemd160_32_x4(input + 32 * i, digest + 20 * i);
+  }
+
+  // Tail, ripemd160_32() pads in place so it needs a 64-byte block
+  uint8_t block[64];
+  for (; i < n; i++) {
+    memcpy(block, input + 32 * i, 32);
+    ripemd160_32(block, digest + 20 * i);
+  }
+
+}
+
 void ripemd160(unsigned char *input,int length,unsigned char *digest) {
 
 	CRIPEMD160 cripe;
@@ -38,6 +38,18 @@ public:
 
 void ripemd160(unsigned char *input,int length,unsigned char *digest);
 void ripemd160_32(unsigned char *input, unsigned char *digest);
+
+// n SHA-256 digests of 32 bytes stored back to back, n hash160 of 20 bytes.
+// Runs on the widest SIMD lanes the CPU supports (4 SSE, 8 AVX2, 16 AVX-512).
+void ripemd160_32_batch(uint8_t *input, int n, uint8_t *digest);
+// Lane width used by ripemd160_32_batch, 1 for the scalar code
+int ripemd160_32_lanes();
+// Force a lane width (1, 4, 8 or 16), false if the CPU cannot run it
+bool ripemd160_32_set_lanes(int lanes);
+// Lane kernels, hash exactly 4, 8 or 16 digests
+void ripemd160_32_x4(const uint8_t *input, uint8_t *digest);
+void ripemd160_32_x8(const uint8_t *input, uint8_t *digest);
+void ripemd160_32_x16(const uint8_t *input, uint8_t *digest);
 std::string ripemd160_hex(unsigned char *digest);
 
 static inline bool ripemd160_comp_hash(uint8_t *h0, uint8_t *h1) {
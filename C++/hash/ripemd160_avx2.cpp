@@ -0,0 +1,4 @@
+// 8-lane RIPEMD-160, see ripemd160_simd.h
+#define RIPEMD160_LANES 8
+#define RIPEMD160_32_LANES ripemd160_32_x8
+#include "ripemd160_simd.h"
@@ -0,0 +1,4 @@
+// 16-lane RIPEMD-160, see ripemd160_simd.h
+#define RIPEMD160_LANES 16
+#define RIPEMD160_32_LANES ripemd160_32_x16
+#include "ripemd160_simd.h"
@@ -0,0 +1,255 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multi-lane RIPEMD-160 of 32-byte SHA-256 digests.
+// Included by ripemd160_sse.cpp, ripemd160_avx2.cpp and ripemd160_avx512.cpp
+// the same way as sha256_simd.h, RIPEMD160_LANES gives the lane count.
+// Lane l hashes input[32*l .. 32*l+31] into digest[20*l .. 20*l+19].
+
+#include <stdint.h>
+#include <string.h>
+#include "ripemd160.h"
+
+namespace {
+
+typedef uint32_t vu32 __attribute__((vector_size(4 * RIPEMD160_LANES)));
+
+#define VROL(x,n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define f1(x, y, z) (x ^ y ^ z)
+#define f2(x, y, z) ((x & y) | (~x & z))
+#define f3(x, y, z) ((x | ~y) ^ z)
+#define f4(x, y, z) ((x & z) | (~z & y))
+#define f5(x, y, z) (x ^ (y | ~z))
+
+#define Round(a,b,c,d,e,f,x,k,r) \
+  a = VROL(a + f + x + (uint32_t)k, r) + e; \
+  c = VROL(c, 10);
+
+#define R11(a,b,c,d,e,x,r) Round(a, b, c, d, e, f1(b, c, d), x, 0, r)
+#define R21(a,b,c,d,e,x,r) Round(a, b, c, d, e, f2(b, c, d), x, 0x5A827999ul, r)
+#define R31(a,b,c,d,e,x,r) Round(a, b, c, d, e, f3(b, c, d), x, 0x6ED9EBA1ul, r)
+#define R41(a,b,c,d,e,x,r) Round(a, b, c, d, e, f4(b, c, d), x, 0x8F1BBCDCul, r)
+#define R51(a,b,c,d,e,x,r) Round(a, b, c, d, e, f5(b, c, d), x, 0xA953FD4Eul, r)
+#define R12(a,b,c,d,e,x,r) Round(a, b, c, d, e, f5(b, c, d), x, 0x50A28BE6ul, r)
+#define R22(a,b,c,d,e,x,r) Round(a, b, c, d, e, f4(b, c, d), x, 0x5C4DD124ul, r)
+#define R32(a,b,c,d,e,x,r) Round(a, b, c, d, e, f3(b, c, d), x, 0x6D703EF3ul, r)
+#define R42(a,b,c,d,e,x,r) Round(a, b, c, d, e, f2(b, c, d), x, 0x7A6D76E9ul, r)
+#define R52(a,b,c,d,e,x,r) Round(a, b, c, d, e, f1(b, c, d), x, 0, r)
+
+}
+
+void RIPEMD160_32_LANES(const uint8_t *input, uint8_t *digest) {
+
+  vu32 w[16];
+
+  // Transpose the digests, one little endian word of every lane per vector.
+  // Byte 32 is the 0x80 padding and the length is 256 bits.
+  for (int l = 0; l < RIPEMD160_LANES; l++) {
+    uint32_t in[8];
+    memcpy(in, input + 32 * l, 32);
+    for (int j = 0; j < 8; j++)
+      w[j][l] = in[j];
+  }
+  w[8] = (vu32){} + 0x80u;
+  w[9] = w[10] = w[11] = w[12] = w[13] = w[15] = (vu32){} + 0u;
+  w[14] = (vu32){} + 256u;
+
+  vu32 a1 = (vu32){} + 0x67452301u;
+  vu32 b1 = (vu32){} + 0xEFCDAB89u;
+  vu32 c1 = (vu32){} + 0x98BADCFEu;
+  vu32 d1 = (vu32){} + 0x10325476u;
+  vu32 e1 = (vu32){} + 0xC3D2E1F0u;
+  vu32 a2 = a1, b2 = b1, c2 = c1, d2 = d1, e2 = e1;
+
+  R11(a1, b1, c1, d1, e1, w[0], 11);
+  R12(a2, b2, c2, d2, e2, w[5], 8);
+  R11(e1, a1, b1, c1, d1, w[1], 14);
+  R12(e2, a2, b2, c2, d2, w[14], 9);
+  R11(d1, e1, a1, b1, c1, w[2], 15);
+  R12(d2, e2, a2, b2, c2, w[7], 9);
+  R11(c1, d1, e1, a1, b1, w[3], 12);
+  R12(c2, d2, e2, a2, b2, w[0], 11);
+  R11(b1, c1, d1, e1, a1, w[4], 5);
+  R12(b2, c2, d2, e2, a2, w[9], 13);
+  R11(a1, b1, c1, d1, e1, w[5], 8);
+  R12(a2, b2, c2, d2, e2, w[2], 15);
+  R11(e1, a1, b1, c1, d1, w[6], 7);
+  R12(e2, a2, b2, c2, d2, w[11], 15);
+  R11(d1, e1, a1, b1, c1, w[7], 9);
+  R12(d2, e2, a2, b2, c2, w[4], 5);
+  R11(c1, d1, e1, a1, b1, w[8], 11);
+  R12(c2, d2, e2, a2, b2, w[13], 7);
+  R11(b1, c1, d1, e1, a1, w[9], 13);
+  R12(b2, c2, d2, e2, a2, w[6], 7);
+  R11(a1, b1, c1, d1, e1, w[10], 14);
+  R12(a2, b2, c2, d2, e2, w[15], 8);
+  R11(e1, a1, b1, c1, d1, w[11], 15);
+  R12(e2, a2, b2, c2, d2, w[8], 11);
+  R11(d1, e1, a1, b1, c1, w[12], 6);
+  R12(d2, e2, a2, b2, c2, w[1], 14);
+  R11(c1, d1, e1, a1, b1, w[13], 7);
+  R12(c2, d2, e2, a2, b2, w[10], 14);
+  R11(b1, c1, d1, e1, a1, w[14], 9);
+  R12(b2, c2, d2, e2, a2, w[3], 12);
+  R11(a1, b1, c1, d1, e1, w[15], 8);
+  R12(a2, b2, c2, d2, e2, w[12], 6);
+
+  R21(e1, a1, b1, c1, d1, w[7], 7);
+  R22(e2, a2, b2, c2, d2, w[6], 9);
+  R21(d1, e1, a1, b1, c1, w[4], 6);
+  R22(d2, e2, a2, b2, c2, w[11], 13);
+  R21(c1, d1, e1, a1, b1, w[13], 8);
+  R22(c2, d2, e2, a2, b2, w[3], 15);
+  R21(b1, c1, d1, e1, a1, w[1], 13);
+  R22(b2, c2, d2, e2, a2, w[7], 7);
+  R21(a1, b1, c1, d1, e1, w[10], 11);
+  R22(a2, b2, c2, d2, e2, w[0], 12);
+  R21(e1, a1, b1, c1, d1, w[6], 9);
+  R22(e2, a2, b2, c2, d2, w[13], 8);
+  R21(d1, e1, a1, b1, c1, w[15], 7);
+  R22(d2, e2, a2, b2, c2, w[5], 9);
+  R21(c1, d1, e1, a1, b1, w[3], 15);
+  R22(c2, d2, e2, a2, b2, w[10], 11);
+  R21(b1, c1, d1, e1, a1, w[12], 7);
+  R22(b2, c2, d2, e2, a2, w[14], 7);
+  R21(a1, b1, c1, d1, e1, w[0], 12);
+  R22(a2, b2, c2, d2, e2, w[15], 7);
+  R21(e1, a1, b1, c1, d1, w[9], 15);
+  R22(e2, a2, b2, c2, d2, w[8], 12);
+  R21(d1, e1, a1, b1, c1, w[5], 9);
+  R22(d2, e2, a2, b2, c2, w[12], 7);
+  R21(c1, d1, e1, a1, b1, w[2], 11);
+  R22(c2, d2, e2, a2, b2, w[4], 6);
+  R21(b1, c1, d1, e1, a1, w[14], 7);
+  R22(b2, c2, d2, e2, a2, w[9], 15);
+  R21(a1, b1, c1, d1, e1, w[11], 13);
+  R22(a2, b2, c2, d2, e2, w[1], 13);
+  R21(e1, a1, b1, c1, d1, w[8], 12);
+  R22(e2, a2, b2, c2, d2, w[2], 11);
+
+  R31(d1, e1, a1, b1, c1, w[3], 11);
+  R32(d2, e2, a2, b2, c2, w[15], 9);
+  R31(c1, d1, e1, a1, b1, w[10], 13);
+  R32(c2, d2, e2, a2, b2, w[5], 7);
+  R31(b1, c1, d1, e1, a1, w[14], 6);
+  R32(b2, c2, d2, e2, a2, w[1], 15);
+  R31(a1, b1, c1, d1, e1, w[4], 7);
+  R32(a2, b2, c2, d2, e2, w[3], 11);
+  R31(e1, a1, b1, c1, d1, w[9], 14);
+  R32(e2, a2, b2, c2, d2, w[7], 8);
+  R31(d1, e1, a1, b1, c1, w[15], 9);
+  R32(d2, e2, a2, b2, c2, w[14], 6);
+  R31(c1, d1, e1, a1, b1, w[8], 13);
+  R32(c2, d2, e2, a2, b2, w[6], 6);
+  R31(b1, c1, d1, e1, a1, w[1], 15);
+  R32(b2, c2, d2, e2, a2, w[9], 14);
+  R31(a1, b1, c1, d1, e1, w[2], 14);
+  R32(a2, b2, c2, d2, e2, w[11], 12);
+  R31(e1, a1, b1, c1, d1, w[7], 8);
+  R32(e2, a2, b2, c2, d2, w[8], 13);
+  R31(d1, e1, a1, b1, c1, w[0], 13);
+  R32(d2, e2, a2, b2, c2, w[12], 5);
+  R31(c1, d1, e1, a1, b1, w[6], 6);
+  R32(c2, d2, e2, a2, b2, w[2], 14);
+  R31(b1, c1, d1, e1, a1, w[13], 5);
+  R32(b2, c2, d2, e2, a2, w[10], 13);
+  R31(a1, b1, c1, d1, e1, w[11], 12);
+  R32(a2, b2, c2, d2, e2, w[0], 13);
+  R31(e1, a1, b1, c1, d1, w[5], 7);
+  R32(e2, a2, b2, c2, d2, w[4], 7);
+  R31(d1, e1, a1, b1, c1, w[12], 5);
+  R32(d2, e2, a2, b2, c2, w[13], 5);
+
+  R41(c1, d1, e1, a1, b1, w[1], 11);
+  R42(c2, d2, e2, a2, b2, w[8], 15);
+  R41(b1, c1, d1, e1, a1, w[9], 12);
+  R42(b2, c2, d2, e2, a2, w[6], 5);
+  R41(a1, b1, c1, d1, e1, w[11], 14);
+  R42(a2, b2, c2, d2, e2, w[4], 8);
+  R41(e1, a1, b1, c1, d1, w[10], 15);
+  R42(e2, a2, b2, c2, d2, w[1], 11);
+  R41(d1, e1, a1, b1, c1, w[0], 14);
+  R42(d2, e2, a2, b2, c2, w[3], 14);
+  R41(c1, d1, e1, a1, b1, w[8], 15);
+  R42(c2, d2, e2, a2, b2, w[11], 14);
+  R41(b1, c1, d1, e1, a1, w[12], 9);
+  R42(b2, c2, d2, e2, a2, w[15], 6);
+  R41(a1, b1, c1, d1, e1, w[4], 8);
+  R42(a2, b2, c2, d2, e2, w[0], 14);
+  R41(e1, a1, b1, c1, d1, w[13], 9);
+  R42(e2, a2, b2, c2, d2, w[5], 6);
+  R41(d1, e1, a1, b1, c1, w[3], 14);
+  R42(d2, e2, a2, b2, c2, w[12], 9);
+  R41(c1, d1, e1, a1, b1, w[7], 5);
+  R42(c2, d2, e2, a2, b2, w[2], 12);
+  R41(b1, c1, d1, e1, a1, w[15], 6);
+  R42(b2, c2, d2, e2, a2, w[13], 9);
+  R41(a1, b1, c1, d1, e1, w[14], 8);
+  R42(a2, b2, c2, d2, e2, w[9], 12);
+  R41(e1, a1, b1, c1, d1, w[5], 6);
+  R42(e2, a2, b2, c2, d2, w[7], 5);
+  R41(d1, e1, a1, b1, c1, w[6], 5);
+  R42(d2, e2, a2, b2, c2, w[10], 15);
+  R41(c1, d1, e1, a1, b1, w[2], 12);
+  R42(c2, d2, e2, a2, b2, w[14], 8);
+
+  R51(b1, c1, d1, e1, a1, w[4], 9);
+  R52(b2, c2, d2, e2, a2, w[12], 8);
+  R51(a1, b1, c1, d1, e1, w[0], 15);
+  R52(a2, b2, c2, d2, e2, w[15], 5);
+  R51(e1, a1, b1, c1, d1, w[5], 5);
+  R52(e2, a2, b2, c2, d2, w[10], 12);
+  R51(d1, e1, a1, b1, c1, w[9], 11);
+  R52(d2, e2, a2, b2, c2, w[4], 9);
+  R51(c1, d1, e1, a1, b1, w[7], 6);
+  R52(c2, d2, e2, a2, b2, w[1], 12);
+  R51(b1, c1, d1, e1, a1, w[12], 8);
+  R52(b2, c2, d2, e2, a2, w[5], 5);
+  R51(a1, b1, c1, d1, e1, w[2], 13);
+  R52(a2, b2, c2, d2, e2, w[8], 14);
+  R51(e1, a1, b1, c1, d1, w[10], 12);
+  R52(e2, a2, b2, c2, d2, w[7], 6);
+  R51(d1, e1, a1, b1, c1, w[14], 5);
+  R52(d2, e2, a2, b2, c2, w[6], 8);
+  R51(c1, d1, e1, a1, b1, w[1], 12);
+  R52(c2, d2, e2, a2, b2, w[2], 13);
+  R51(b1, c1, d1, e1, a1, w[3], 13);
+  R52(b2, c2, d2, e2, a2, w[13], 6);
+  R51(a1, b1, c1, d1, e1, w[8], 14);
+  R52(a2, b2, c2, d2, e2, w[14], 5);
+  R51(e1, a1, b1, c1, d1, w[11], 11);
+  R52(e2, a2, b2, c2, d2, w[0], 15);
+  R51(d1, e1, a1, b1, c1, w[6], 8);
+  R52(d2, e2, a2, b2, c2, w[3], 13);
+  R51(c1, d1, e1, a1, b1, w[15], 5);
+  R52(c2, d2, e2, a2, b2, w[9], 11);
+  R51(b1, c1, d1, e1, a1, w[13], 6);
+  R52(b2, c2, d2, e2, a2, w[11], 11);
+
+  vu32 s0 = 0xEFCDAB89u + c1 + d2;
+  vu32 s1 = 0x98BADCFEu + d1 + e2;
+  vu32 s2 = 0x10325476u + e1 + a2;
+  vu32 s3 = 0xC3D2E1F0u + a1 + b2;
+  vu32 s4 = 0x67452301u + b1 + c2;
+
+  for (int l = 0; l < RIPEMD160_LANES; l++) {
+    uint32_t out[5] = { s0[l], s1[l], s2[l], s3[l], s4[l] };
+    memcpy(digest + 20 * l, out, 20);
+  }
+
+}
@@ -0,0 +1,4 @@
+// 4-lane RIPEMD-160, see ripemd160_simd.h
+#define RIPEMD160_LANES 4
+#define RIPEMD160_32_LANES ripemd160_32_x4
+#include "ripemd160_simd.h"
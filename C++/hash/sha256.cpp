@@ -16,7 +16,10 @@
 */
 
 #include <string.h>
+#include <chrono>
+#include <atomic>
 #include "sha256.h"
+#include "../util/Cpu.h"
 
 #define BSWAP
 
@@ -349,8 +352,31 @@ inline uint32_t _rotr(uint32_t x, uint8_t r) {
 
   }
 
+  static bool useShaNi = cpu_features().sha;
+
+  // Transform nbBlock consecutive chunks, with SHA-NI when available
+  inline void TransformBlocks(uint32_t* s, const unsigned char* chunk, int nbBlock) {
+    if (useShaNi) {
+      sha256_shani_transform(s, chunk, nbBlock);
+    } else {
+      for (int i = 0; i < nbBlock; i++)
+        Transform(s, chunk + 64 * i);
+    }
+  }
+
 } // namespace sha256
 
+bool sha256_shani() {
+  return _sha256::useShaNi;
+}
+
+bool sha256_set_shani(bool enable) {
+  if (enable && !cpu_features().sha)
+    return false;
+  _sha256::useShaNi = enable;
+  return true;
+}
+
 
 ////// SHA-256
 
@@ -391,14 +417,15 @@ void CSHA256::Write(const unsigned char* data, size_t len)
     memcpy(buf + bufsize, data, 64 - bufsize);
     bytes += 64 - bufsize;
     data += 64 - bufsize;
-    _sha256::Transform(s, buf);
+    _sha256::TransformBlocks(s, buf, 1);
     bufsize = 0;
   }
-  while (end >= data + 64) {
+  if (end >= data + 64) {
     // Process full chunks directly from the source.
-    _sha256::Transform(s, data);
-    bytes += 64;
-    data += 64;
+    size_t nb = (end - data) / 64;
+    _sha256::TransformBlocks(s, data, (int)nb);
+    bytes += 64 * nb;
+    data += 64 * nb;
   }
   if (end > data) {
     // Fill the buffer with what remains.
@@ -442,7 +469,7 @@ void sha256_33(unsigned char *input, unsigned char *digest) {
   _sha256::Initialize(s);
   memcpy(input + 33, _sha256::pad, 23);
   memcpy(input + 56, sizedesc_33, 8);
-  _sha256::Transform(s, input);
+  _sha256::TransformBlocks(s, input, 1);
 
   WRITEBE32(digest, s[0]);
   WRITEBE32(digest + 4, s[1]);
@@ -464,8 +491,7 @@ void sha256_65(unsigned char *input, unsigned char *digest) {
   memcpy(input + 120, sizedesc_65, 8);
 
   _sha256::Initialize(s);
-  _sha256::Transform(s, input);
-  _sha256::Transform(s, input+64);
+  _sha256::TransformBlocks(s, input, 2);
 
   WRITEBE32(digest, s[0]);
   WRITEBE32(digest + 4, s[1]);
@@ -485,11 +511,152 @@ void sha256_checksum(uint8_t *input, int length, uint8_t *checksum) {
   memcpy(b,input,length);
   memcpy(b + length, _sha256::pad, 56-length);
   WRITEBE64(b + 56, length << 3);
-  _sha256::Transform2(s, b);
+  if (_sha256::useShaNi) {
+    // Second pass over the 32-byte digest, padded to one block
+    _sha256::Initialize(s);
+    _sha256::TransformBlocks(s, b, 1);
+    for (int i = 0; i < 8; i++)
+      WRITEBE32(b + 4 * i, s[i]);
+    memcpy(b + 32, _sha256::pad, 24);
+    memcpy(b + 56, sizedesc_32, 8);
+    _sha256::Initialize(s);
+    _sha256::TransformBlocks(s, b, 1);
+  } else {
+    _sha256::Transform2(s, b);
+  }
   WRITEBE32(checksum,s[0]);
 
 }
 
+// 0 until resolved, read and set from any thread
+static std::atomic<int> batchLanes(0);
+
+static void sha256_33_lanes_batch(int lanes, uint8_t *input, int n, uint8_t *digest);
+
+// Time one batch of keys with the given lane width
+static double time_lanes(int lanes, uint8_t *keys, uint8_t *digests, int n) {
+  sha256_33_lanes_batch(lanes, keys, n, digests);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < 8; r++)
+    sha256_33_lanes_batch(lanes, keys, n, digests);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Widest SIMD lanes, or the one-key SHA-NI path when it is measured faster
+static int best_lanes() {
+
+  const CpuFeatures &cpu = cpu_features();
+  int simd = cpu.avx512f ? 16 : (cpu.avx2 ? 8 : 4);
+  if (!_sha256::useShaNi)
+    return simd;
+
+  const int n = 256;
+  uint8_t keys[33 * n], digests[32 * n];
+  for (int i = 0; i < 33 * n; i++)
+    keys[i] = (uint8_t)(i * 131 + 7);
+  double tSimd = time_lanes(simd, keys, digests, n);
+  double tShaNi = time_lanes(1, keys, digests, n);
+  return (tShaNi < tSimd) ? 1 : simd;
+
+}
+
+int sha256_33_lanes() {
+  int lanes = batchLanes;
+  if (lanes == 0) {
+    static const int best = best_lanes();
+    // A width set meanwhile by sha256_33_set_lanes is kept
+    if (batchLanes.compare_exchange_strong(lanes, best))
+      lanes = best;
+  }
+  return lanes;
+}
+
+bool sha256_33_set_lanes(int lanes) {
+  const CpuFeatures &cpu = cpu_features();
+  if ((lanes == 16 && !cpu.avx512f) || (lanes == 8 && !cpu.avx2) ||
+      (lanes != 1 && lanes != 4 && lanes != 8 && lanes != 16))
+    return false;
+  batchLanes = lanes;
+  return true;
+}
+
+void sha256_33_batch(uint8_t *input, int n, uint8_t *digest) {
+  sha256_33_lanes_batch(sha256_33_lanes(), input, n, digest);
+}
+
+static void sha256_33_lanes_batch(int lanes, uint8_t *input, int n, uint8_t *digest) {
+
+  int i = 0;
+
+  if (lanes == 16) {
+    for (; i + 16 <= n; i += 16)
+      sha256_33_x16(input + 33 * i, digest + 32 * i);
+  } else if (lanes == 8) {
+    for (; i + 8 <= n; i += 8)
+      sha256_33_x8(input + 33 * i, digest + 32 * i);
+  }
+  if (lanes > 1) {
+    for (; i + 4 <= n; i += 4)
+      sha256_33_x4(input + 33 * i, digest + 32 * i);
+  }
+
+  // Tail, sha256_33() pads in place so it needs a 64-byte block
+  uint8_t block[64];
+  for (; i < n; i++) {
+    memcpy(block, input + 33 * i, 33);
+    sha256_33(block, digest + 32 * i);
+  }
+
+}
+
+void sha256_65_batch(uint8_t *input, int n, uint8_t *digest) {
+
+  int lanes = sha256_33_lanes();
+  int i = 0;
+
+  if (lanes == 16) {
+    for (; i + 16 <= n; i += 16)
+      sha256_65_x16(input + 65 * i, digest + 32 * i);
+  } else if (lanes == 8) {
+    for (; i + 8 <= n; i += 8)
+      sha256_65_x8(input + 65 * i, digest + 32 * i);
+  }
+  if (lanes > 1) {
+    for (; i + 4 <= n; i += 4)
+      sha256_65_x4(input + 65 * i, digest + 32 * i);
+  }
+
+  // Tail, sha256_65() pads in place so it needs two 64-byte blocks
+  uint8_t block[128];
+  for (; i < n; i++) {
+    memcpy(block, input + 65 * i, 65);
+    sha256_65(block, digest + 32 * i);
+  }
+
+}
+
+void sha256_short_batch(uint8_t *input, int length, int n, uint8_t *digest) {
+
+  int lanes = sha256_33_lanes();
+  int i = 0;
+
+  if (lanes == 16) {
+    for (; i + 16 <= n; i += 16)
+      sha256_short_x16(input + length * i, length, digest + 32 * i);
+  } else if (lanes == 8) {
+    for (; i + 8 <= n; i += 8)
+      sha256_short_x8(input + length * i, length, digest + 32 * i);
+  }
+  if (lanes > 1) {
+    for (; i + 4 <= n; i += 4)
+      sha256_short_x4(input + length * i, length, digest + 32 * i);
+  }
+
+  for (; i < n; i++)
+    sha256(input + length * i, length, digest + 32 * i);
+
+}
+
 std::string sha256_hex(unsigned char *digest) {
 
     char buf[2*32+1];
@@ -24,6 +24,36 @@ void sha256(uint8_t *input,int length, uint8_t *digest);
 void sha256_33(uint8_t *input, uint8_t *digest);
 void sha256_65(uint8_t *input, uint8_t *digest);
 void sha256_checksum(uint8_t *input, int length, uint8_t *checksum);
+
+// SHA-NI is used by the functions above when the CPU has it
+bool sha256_shani();
+// Enable or disable SHA-NI, false if the CPU cannot run it
+bool sha256_set_shani(bool enable);
+// SHA-NI block transform, only valid when the CPU has the SHA extensions
+void sha256_shani_transform(uint32_t *s, const unsigned char *chunk, int nbBlock);
+
+// n compressed keys of 33 bytes stored back to back, n digests of 32 bytes.
+// Runs on the widest SIMD lanes the CPU supports (4 SSE, 8 AVX2, 16 AVX-512),
+// or one key at a time on SHA-NI when that is measured faster on this host.
+void sha256_33_batch(uint8_t *input, int n, uint8_t *digest);
+// Lane width used by sha256_33_batch, 1 for the scalar or SHA-NI code
+int sha256_33_lanes();
+// Force a lane width (1, 4, 8 or 16), false if the CPU cannot run it
+bool sha256_33_set_lanes(int lanes);
+// n uncompressed keys of 65 bytes stored back to back, same lane width
+void sha256_65_batch(uint8_t *input, int n, uint8_t *digest);
+// n messages of length bytes (at most 55) stored back to back, same lane width
+void sha256_short_batch(uint8_t *input, int length, int n, uint8_t *digest);
+// Lane kernels, hash exactly 4, 8 or 16 keys
+void sha256_33_x4(const uint8_t *input, uint8_t *digest);
+void sha256_33_x8(const uint8_t *input, uint8_t *digest);
+void sha256_33_x16(const uint8_t *input, uint8_t *digest);
+void sha256_65_x4(const uint8_t *input, uint8_t *digest);
+void sha256_65_x8(const uint8_t *input, uint8_t *digest);
+void sha256_65_x16(const uint8_t *input, uint8_t *digest);
+void sha256_short_x4(const uint8_t *input, int length, uint8_t *digest);
+void sha256_short_x8(const uint8_t *input, int length, uint8_t *digest);
+void sha256_short_x16(const uint8_t *input, int length, uint8_t *digest);
 std::string sha256_hex(unsigned char *digest);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,233 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multi-lane SHA-256 of 33-byte compressed and 65-byte uncompressed public keys,
+// and of short one-block messages (P2SH redeem scripts).
+// Included by sha256_sse.cpp, sha256_avx2.cpp and sha256_avx512.cpp, each one
+// defines SHA256_LANES and the kernel names before including it
+// and is compiled with the matching -m flag, so the same code gives 4, 8 or 16 lanes.
+// Lane l hashes input[33*l ..] (or input[65*l ..]) into digest[32*l .. 32*l+31].
+
+#include <stdint.h>
+#include <string.h>
+#include "sha256.h"
+
+namespace {
+
+typedef uint32_t vu32 __attribute__((vector_size(4 * SHA256_LANES)));
+
+#define VROR(x,n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define VS0(x) (VROR(x,7) ^ VROR(x,18) ^ ((x) >> 3))
+#define VS1(x) (VROR(x,17) ^ VROR(x,19) ^ ((x) >> 10))
+#define VSig0(x) (VROR(x,2) ^ VROR(x,13) ^ VROR(x,22))
+#define VSig1(x) (VROR(x,6) ^ VROR(x,11) ^ VROR(x,25))
+#define VMaj(x,y,z) ((x & y) | (z & (x | y)))
+#define VCh(x,y,z) (z ^ (x & (y ^ z)))
+
+#define VRound(a, b, c, d, e, f, g, h, k, w) \
+    t1 = h + VSig1(e) + VCh(e,f,g) + (uint32_t)k + (w); \
+    t2 = VSig0(a) + VMaj(a,b,c); \
+    d += t1; \
+    h = t1 + t2;
+
+inline uint32_t LoadBE32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+inline void StoreBE32(uint8_t *p, uint32_t x) {
+  p[0] = (uint8_t)(x >> 24);
+  p[1] = (uint8_t)(x >> 16);
+  p[2] = (uint8_t)(x >> 8);
+  p[3] = (uint8_t)x;
+}
+
+inline void Initialize(vu32 *s) {
+  s[0] = (vu32){} + 0x6a09e667u;
+  s[1] = (vu32){} + 0xbb67ae85u;
+  s[2] = (vu32){} + 0x3c6ef372u;
+  s[3] = (vu32){} + 0xa54ff53au;
+  s[4] = (vu32){} + 0x510e527fu;
+  s[5] = (vu32){} + 0x9b05688cu;
+  s[6] = (vu32){} + 0x1f83d9abu;
+  s[7] = (vu32){} + 0x5be0cd19u;
+}
+
+// One 64-byte block per lane, w holds the 16 message words
+__attribute__((always_inline)) inline void Transform(vu32 *s, const vu32 *w) {
+
+  vu32 t1, t2;
+  vu32 a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+  vu32 w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3], w4 = w[4], w5 = w[5], w6 = w[6], w7 = w[7];
+  vu32 w8 = w[8], w9 = w[9], w10 = w[10], w11 = w[11], w12 = w[12], w13 = w[13], w14 = w[14], w15 = w[15];
+
+  VRound(a, b, c, d, e, f, g, h, 0x428a2f98, (w0));
+  VRound(h, a, b, c, d, e, f, g, 0x71374491, (w1));
+  VRound(g, h, a, b, c, d, e, f, 0xb5c0fbcf, (w2));
+  VRound(f, g, h, a, b, c, d, e, 0xe9b5dba5, (w3));
+  VRound(e, f, g, h, a, b, c, d, 0x3956c25b, (w4));
+  VRound(d, e, f, g, h, a, b, c, 0x59f111f1, (w5));
+  VRound(c, d, e, f, g, h, a, b, 0x923f82a4, (w6));
+  VRound(b, c, d, e, f, g, h, a, 0xab1c5ed5, (w7));
+  VRound(a, b, c, d, e, f, g, h, 0xd807aa98, (w8));
+  VRound(h, a, b, c, d, e, f, g, 0x12835b01, (w9));
+  VRound(g, h, a, b, c, d, e, f, 0x243185be, (w10));
+  VRound(f, g, h, a, b, c, d, e, 0x550c7dc3, (w11));
+  VRound(e, f, g, h, a, b, c, d, 0x72be5d74, (w12));
+  VRound(d, e, f, g, h, a, b, c, 0x80deb1fe, (w13));
+  VRound(c, d, e, f, g, h, a, b, 0x9bdc06a7, (w14));
+  VRound(b, c, d, e, f, g, h, a, 0xc19bf174, (w15));
+
+  VRound(a, b, c, d, e, f, g, h, 0xe49b69c1, (w0 += VS1(w14) + w9 + VS0(w1)));
+  VRound(h, a, b, c, d, e, f, g, 0xefbe4786, (w1 += VS1(w15) + w10 + VS0(w2)));
+  VRound(g, h, a, b, c, d, e, f, 0x0fc19dc6, (w2 += VS1(w0) + w11 + VS0(w3)));
+  VRound(f, g, h, a, b, c, d, e, 0x240ca1cc, (w3 += VS1(w1) + w12 + VS0(w4)));
+  VRound(e, f, g, h, a, b, c, d, 0x2de92c6f, (w4 += VS1(w2) + w13 + VS0(w5)));
+  VRound(d, e, f, g, h, a, b, c, 0x4a7484aa, (w5 += VS1(w3) + w14 + VS0(w6)));
+  VRound(c, d, e, f, g, h, a, b, 0x5cb0a9dc, (w6 += VS1(w4) + w15 + VS0(w7)));
+  VRound(b, c, d, e, f, g, h, a, 0x76f988da, (w7 += VS1(w5) + w0 + VS0(w8)));
+  VRound(a, b, c, d, e, f, g, h, 0x983e5152, (w8 += VS1(w6) + w1 + VS0(w9)));
+  VRound(h, a, b, c, d, e, f, g, 0xa831c66d, (w9 += VS1(w7) + w2 + VS0(w10)));
+  VRound(g, h, a, b, c, d, e, f, 0xb00327c8, (w10 += VS1(w8) + w3 + VS0(w11)));
+  VRound(f, g, h, a, b, c, d, e, 0xbf597fc7, (w11 += VS1(w9) + w4 + VS0(w12)));
+  VRound(e, f, g, h, a, b, c, d, 0xc6e00bf3, (w12 += VS1(w10) + w5 + VS0(w13)));
+  VRound(d, e, f, g, h, a, b, c, 0xd5a79147, (w13 += VS1(w11) + w6 + VS0(w14)));
+  VRound(c, d, e, f, g, h, a, b, 0x06ca6351, (w14 += VS1(w12) + w7 + VS0(w15)));
+  VRound(b, c, d, e, f, g, h, a, 0x14292967, (w15 += VS1(w13) + w8 + VS0(w0)));
+
+  VRound(a, b, c, d, e, f, g, h, 0x27b70a85, (w0 += VS1(w14) + w9 + VS0(w1)));
+  VRound(h, a, b, c, d, e, f, g, 0x2e1b2138, (w1 += VS1(w15) + w10 + VS0(w2)));
+  VRound(g, h, a, b, c, d, e, f, 0x4d2c6dfc, (w2 += VS1(w0) + w11 + VS0(w3)));
+  VRound(f, g, h, a, b, c, d, e, 0x53380d13, (w3 += VS1(w1) + w12 + VS0(w4)));
+  VRound(e, f, g, h, a, b, c, d, 0x650a7354, (w4 += VS1(w2) + w13 + VS0(w5)));
+  VRound(d, e, f, g, h, a, b, c, 0x766a0abb, (w5 += VS1(w3) + w14 + VS0(w6)));
+  VRound(c, d, e, f, g, h, a, b, 0x81c2c92e, (w6 += VS1(w4) + w15 + VS0(w7)));
+  VRound(b, c, d, e, f, g, h, a, 0x92722c85, (w7 += VS1(w5) + w0 + VS0(w8)));
+  VRound(a, b, c, d, e, f, g, h, 0xa2bfe8a1, (w8 += VS1(w6) + w1 + VS0(w9)));
+  VRound(h, a, b, c, d, e, f, g, 0xa81a664b, (w9 += VS1(w7) + w2 + VS0(w10)));
+  VRound(g, h, a, b, c, d, e, f, 0xc24b8b70, (w10 += VS1(w8) + w3 + VS0(w11)));
+  VRound(f, g, h, a, b, c, d, e, 0xc76c51a3, (w11 += VS1(w9) + w4 + VS0(w12)));
+  VRound(e, f, g, h, a, b, c, d, 0xd192e819, (w12 += VS1(w10) + w5 + VS0(w13)));
+  VRound(d, e, f, g, h, a, b, c, 0xd6990624, (w13 += VS1(w11) + w6 + VS0(w14)));
+  VRound(c, d, e, f, g, h, a, b, 0xf40e3585, (w14 += VS1(w12) + w7 + VS0(w15)));
+  VRound(b, c, d, e, f, g, h, a, 0x106aa070, (w15 += VS1(w13) + w8 + VS0(w0)));
+
+  VRound(a, b, c, d, e, f, g, h, 0x19a4c116, (w0 += VS1(w14) + w9 + VS0(w1)));
+  VRound(h, a, b, c, d, e, f, g, 0x1e376c08, (w1 += VS1(w15) + w10 + VS0(w2)));
+  VRound(g, h, a, b, c, d, e, f, 0x2748774c, (w2 += VS1(w0) + w11 + VS0(w3)));
+  VRound(f, g, h, a, b, c, d, e, 0x34b0bcb5, (w3 += VS1(w1) + w12 + VS0(w4)));
+  VRound(e, f, g, h, a, b, c, d, 0x391c0cb3, (w4 += VS1(w2) + w13 + VS0(w5)));
+  VRound(d, e, f, g, h, a, b, c, 0x4ed8aa4a, (w5 += VS1(w3) + w14 + VS0(w6)));
+  VRound(c, d, e, f, g, h, a, b, 0x5b9cca4f, (w6 += VS1(w4) + w15 + VS0(w7)));
+  VRound(b, c, d, e, f, g, h, a, 0x682e6ff3, (w7 += VS1(w5) + w0 + VS0(w8)));
+  VRound(a, b, c, d, e, f, g, h, 0x748f82ee, (w8 += VS1(w6) + w1 + VS0(w9)));
+  VRound(h, a, b, c, d, e, f, g, 0x78a5636f, (w9 += VS1(w7) + w2 + VS0(w10)));
+  VRound(g, h, a, b, c, d, e, f, 0x84c87814, (w10 += VS1(w8) + w3 + VS0(w11)));
+  VRound(f, g, h, a, b, c, d, e, 0x8cc70208, (w11 += VS1(w9) + w4 + VS0(w12)));
+  VRound(e, f, g, h, a, b, c, d, 0x90befffa, (w12 += VS1(w10) + w5 + VS0(w13)));
+  VRound(d, e, f, g, h, a, b, c, 0xa4506ceb, (w13 += VS1(w11) + w6 + VS0(w14)));
+  VRound(c, d, e, f, g, h, a, b, 0xbef9a3f7, (w14 + VS1(w12) + w7 + VS0(w15)));
+  VRound(b, c, d, e, f, g, h, a, 0xc67178f2, (w15 + VS1(w13) + w8 + VS0(w0)));
+
+  s[0] += a;
+  s[1] += b;
+  s[2] += c;
+  s[3] += d;
+  s[4] += e;
+  s[5] += f;
+  s[6] += g;
+  s[7] += h;
+
+}
+
+inline void Store(const vu32 *s, uint8_t *digest) {
+  for (int l = 0; l < SHA256_LANES; l++) {
+    uint8_t *out = digest + 32 * l;
+    for (int i = 0; i < 8; i++)
+      StoreBE32(out + 4 * i, s[i][l]);
+  }
+}
+
+}
+
+void SHA256_33_LANES(const uint8_t *input, uint8_t *digest) {
+
+  vu32 s[8], w[16];
+
+  // Transpose the keys, one 32-bit word of every lane per vector.
+  // Byte 33 is the 0x80 padding and the length is 264 bits.
+  for (int l = 0; l < SHA256_LANES; l++) {
+    const uint8_t *in = input + 33 * l;
+    for (int i = 0; i < 8; i++)
+      w[i][l] = LoadBE32(in + 4 * i);
+    w[8][l] = ((uint32_t)in[32] << 24) | 0x800000;
+  }
+  for (int i = 9; i < 15; i++)
+    w[i] = (vu32){} + 0u;
+  w[15] = (vu32){} + 264u;
+
+  Initialize(s);
+  Transform(s, w);
+  Store(s, digest);
+
+}
+
+void SHA256_65_LANES(const uint8_t *input, uint8_t *digest) {
+
+  vu32 s[8], w[16];
+
+  Initialize(s);
+
+  for (int l = 0; l < SHA256_LANES; l++) {
+    const uint8_t *in = input + 65 * l;
+    for (int i = 0; i < 16; i++)
+      w[i][l] = LoadBE32(in + 4 * i);
+  }
+  Transform(s, w);
+
+  // Byte 64, the 0x80 padding and the length of 520 bits
+  for (int l = 0; l < SHA256_LANES; l++)
+    w[0][l] = ((uint32_t)input[65 * l + 64] << 24) | 0x800000;
+  for (int i = 1; i < 15; i++)
+    w[i] = (vu32){} + 0u;
+  w[15] = (vu32){} + 520u;
+  Transform(s, w);
+
+  Store(s, digest);
+
+}
+
+void SHA256_SHORT_LANES(const uint8_t *input, int length, uint8_t *digest) {
+
+  vu32 s[8], w[16];
+  uint8_t block[64];
+
+  // One padded block per lane, length is at most 55 bytes
+  for (int l = 0; l < SHA256_LANES; l++) {
+    memcpy(block, input + length * l, length);
+    block[length] = 0x80;
+    memset(block + length + 1, 0, 63 - length);
+    for (int i = 0; i < 15; i++)
+      w[i][l] = LoadBE32(block + 4 * i);
+  }
+  w[14] = (vu32){} + 0u;
+  w[15] = (vu32){} + (uint32_t)(length * 8);
+
+  Initialize(s);
+  Transform(s, w);
+  Store(s, digest);
+
+}
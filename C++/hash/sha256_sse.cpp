@@ -0,0 +1,6 @@
+// 4-lane SHA-256, see sha256_simd.h
+#define SHA256_LANES 4
+#define SHA256_33_LANES sha256_33_x4
+#define SHA256_65_LANES sha256_65_x4
+#define SHA256_SHORT_LANES sha256_short_x4
+#include "sha256_simd.h"
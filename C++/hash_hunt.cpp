@@ -3,16 +3,27 @@
 #include <vector>
 #include <thread>
 #include <string>
+#include <mutex>
+#include <algorithm>
 
 #include "secp256k1/SECP256k1.h"
 #include "secp256k1/Int.h"
 #include "secp256k1/IntGroup.h"
+#include "secp256k1/FieldElement.h"
+#include "hash/ripemd160.h"
 #include "util/util.h"
+#include "util/Scheduler.h"
+#include "util/Checkpoint.h"
+#include "util/Reporter.h"
+#include "target/TargetSet.h"
 
 using namespace std;
 
 const int cpuCores = std::thread::hardware_concurrency();
+const uint64_t CHUNK_SIZE = 1 << 20; // default keys per scheduler chunk
 const char hex_chars[] = "0123456789abcdef";
+const uint32_t CHECKPOINT_KEY_MASK = 4095; // publish the position every 4096 keys
+const int HASH_BATCH_SIZE = 256; // keys hashed together by GetHash160Batch
 
 std::string bytesToHexString(const unsigned char* data) {
     
@@ -31,7 +42,7 @@ std::string bytesToHexString(const unsigned char* data) {
 
 auto main() -> int {
 
-    Secp256K1* secp256k1 = new Secp256K1(); secp256k1->Init();
+    Secp256K1* secp256k1 = new Secp256K1();
     
     Int pk; pk.SetInt32(1);
     uint64_t mult = 2;
@@ -48,69 +59,341 @@ auto main() -> int {
     ifstream inFile("settings.txt");
     getline(inFile, temp); range_end = std::stoull(temp);
     getline(inFile, temp); target_hash = trim(temp);
+    
+    // Optional "key = value" lines
+    string checkpoint_file = "checkpoint.txt", option, value;
+    int checkpoint_interval = 60;
+    int report_interval = 10;
+    string key_type = "compressed";
+    int nb_threads = cpuCores;
+    uint64_t chunk_size = CHUNK_SIZE;
+    string gtable_cache;
+    string modinv = "drs62";
+    while (getline(inFile, temp)) {
+        if (!parse_option(temp, option, value))
+            continue;
+        if (option == "checkpoint") {
+            checkpoint_file = value;
+        } else if (option == "checkpoint_interval") {
+            checkpoint_interval = std::stoi(value);
+        } else if (option == "key_type") {
+            key_type = value;
+        } else if (option == "report_interval") {
+            report_interval = std::stoi(value);
+        } else if (option == "threads") {
+            nb_threads = std::stoi(value);
+        } else if (option == "chunk_size") {
+            chunk_size = std::stoull(value);
+        } else if (option == "gtable_cache") {
+            gtable_cache = value;
+        } else if (option == "modinv") {
+            modinv = value;
+        } else {
+            print_time(); cout << "Unknown option : " << option << endl;
+        }
+    }
     inFile.close();
+    
+    // Processes sharing a cache file map its generator table instead of
+    // computing it
+    secp256k1->Init(gtable_cache);
+    // Modular inverse of the single key paths (AddPoints, Reduce, chunk starts),
+    // auto times them all and keeps the fastest on this CPU
+    if (modinv == "auto") {
+        Int::SelectModInv();
+    } else if (Int::GetModInvMethod(modinv) >= 0) {
+        Int::SetModInv(Int::GetModInvMethod(modinv));
+    } else {
+        print_time(); cout << "Invalid modinv " << modinv << " (auto, xcd, montgomery, penk, drs62 or safegcd62)" << endl;
+        return -1;
+    }
+    print_time(); cout << "ModInv      : " << Int::GetModInvName(Int::GetModInv()) << endl;
+    if (!gtable_cache.empty()) {
+        int source = secp256k1->GetGTableSource();
+        print_time(); cout << "GTable      : " << (source == GTABLE_MAPPED ? "mapped from " :
+                                                source == GTABLE_SAVED ? "computed, saved to " :
+                                                "computed, cannot write ") << gtable_cache << endl;
+    }
     range_start = range_end - (uint64_t)1;
+    if (nb_threads < 1) nb_threads = 1;
+    if (chunk_size < 1) chunk_size = 1;
     
     print_time(); cout << "Range Start : " << range_start << " bits" << endl;
     print_time(); cout << "Range End   : " << range_end << " bits" << endl;
-    print_time(); cout << "Target Hash : " << target_hash << endl;
+    bool check_compressed = (key_type == "compressed" || key_type == "both");
+    bool check_uncompressed = (key_type == "uncompressed" || key_type == "both");
+    if (!check_compressed && !check_uncompressed) {
+        print_time(); cout << "Invalid key_type " << key_type << " (compressed, uncompressed or both)" << endl;
+        return -1;
+    }
+    print_time(); cout << "Key Type    : " << key_type << endl;
+    print_time(); cout << "Threads     : " << nb_threads << " (" << chunk_size << " keys per chunk)" << endl;
+    
+    // A target that is not a hash160 or an address is a file holding one per line.
+    // P2SH-P2WPKH targets are matched on a second hash of the compressed key hash160,
+    // bech32 (P2WPKH) targets on the compressed key hash160 only.
+    // Known public keys are matched on the x coordinate of the points, without hashing.
+    TargetSet targets, p2sh_targets, bech32_targets, pubkey_targets;
+    uint8_t single_hash[20];
+    int single_type;
+    Point single_pubkey;
+    bool multi_target = !TargetSet::ParseTarget(target_hash, single_hash, &single_type);
+    bool check_p2pkh, check_p2sh, check_bech32, check_pubkey;
+    if (multi_target) {
+        if (!targets.LoadFile(target_hash) || !p2sh_targets.LoadFile(target_hash, P2SH) ||
+            !bech32_targets.LoadFile(target_hash, BECH32) ||
+            !pubkey_targets.LoadFile(target_hash, PUBKEY)) {
+            print_time(); cout << "Cannot open target file " << target_hash << endl;
+            return -1;
+        }
+        targets.Build();
+        p2sh_targets.Build();
+        bech32_targets.Build();
+        pubkey_targets.Build();
+        print_time(); cout << "Target File : " << target_hash << " (" << targets.GetSize() << " hashes, "
+                           << p2sh_targets.GetSize() << " p2sh, " << bech32_targets.GetSize() << " bech32, "
+                           << pubkey_targets.GetSize() << " pubkeys, "
+                           << (targets.GetFilterSize() + p2sh_targets.GetFilterSize() + bech32_targets.GetFilterSize() +
+                               pubkey_targets.GetFilterSize()) / 1024
+                           << " KB filter)" << endl;
+        if (targets.GetNbInvalid() > 0) {
+            print_time(); cout << "Skipped " << targets.GetNbInvalid() << " invalid lines" << endl;
+        }
+        check_p2pkh = targets.GetSize() > 0;
+        check_p2sh = p2sh_targets.GetSize() > 0;
+        check_bech32 = bech32_targets.GetSize() > 0;
+        check_pubkey = pubkey_targets.GetSize() > 0;
+    } else if (single_type == PUBKEY) {
+        bool isCompressed;
+        single_pubkey = secp256k1->ParsePublicKeyHex(target_hash, isCompressed);
+        print_time(); cout << "Target Key  : " << secp256k1->GetPublicKeyHex(true, single_pubkey) << " (pubkey)" << endl;
+        check_p2pkh = false;
+        check_p2sh = false;
+        check_bech32 = false;
+        check_pubkey = true;
+    } else {
+        const char *type_name[] = { "p2pkh", "p2sh", "bech32" };
+        if (target_hash.length() != 40) {
+            print_time(); cout << "Target Addr : " << target_hash << endl;
+        }
+        print_time(); cout << "Target Hash : " << bytesToHexString(single_hash) << " (" << type_name[single_type] << ")" << endl;
+        check_p2pkh = single_type == P2PKH;
+        check_p2sh = single_type == P2SH;
+        check_bech32 = single_type == BECH32;
+        check_pubkey = false;
+    }
+    if (check_p2sh && !check_compressed) {
+        print_time(); cout << "P2SH targets need compressed keys (key_type compressed or both)" << endl;
+        return -1;
+    }
+    if (check_bech32 && !check_compressed) {
+        print_time(); cout << "Bech32 targets need compressed keys (key_type compressed or both)" << endl;
+        return -1;
+    }
+
+    // Full points of the public key targets, for the y check of an x match
+    vector<Point> pubkeys;
+    if (check_pubkey) {
+        if (multi_target) {
+            TargetSet::LoadPublicKeys(target_hash, secp256k1, pubkeys);
+        } else {
+            pubkeys.push_back(single_pubkey);
+        }
+    }
+    
+    std::mutex found_mutex;
+    auto report_found = [&](Int &key, std::string target, const char *suffix) {
+        std::lock_guard<std::mutex> lock(found_mutex);
+        print_time(); cout << "Private key : " << key.GetBase10() << suffix << endl;
+        ofstream outFile;
+        outFile.open("found.txt", ios::app);
+        if (multi_target) {
+            outFile << key.GetBase10() << ' ' << target << suffix << '\n';
+        } else {
+            outFile << key.GetBase10() << suffix << '\n';
+        }
+        outFile.close();
+    };
     
     auto chrono_start = std::chrono::high_resolution_clock::now();
     
+    // Test nb packed hash160 of the keys base, base+1, ... against the targets,
+    // the private key is only rebuilt from the batch index on a match
+    auto check_hashes = [&](Int &base, unsigned char *hashes, int nb, TargetSet &set, const char *kind) {
+        for (int i = 0; i < nb; i++) {
+            unsigned char *hash160 = hashes + 20 * i;
+            if (multi_target ? set.Contains(hash160) : ripemd160_comp_hash(hash160, single_hash)) {
+                Int key(&base);
+                key.Add((uint64_t)i);
+                report_found(key, bytesToHexString(hash160), kind);
+                if (!multi_target) {
+                    print_elapsed_time(chrono_start);
+                    exit(0);
+                }
+            }
+        }
+    };
+    
+    // Test the x coordinate of nb points of the keys base, base+1, ... against the
+    // known public keys. kG and -kG share x, the target point tells them apart by y :
+    // the key reported is the one of the target, written out with its public key.
+    auto check_points = [&](Int &base, AffinePoint *points, int nb) {
+        for (int i = 0; i < nb; i++) {
+            uint64_t *x = points[i].x;
+            if (multi_target ? pubkey_targets.Contains((uint8_t *)x)
+                             : x[0] == single_pubkey.x.bits64[0]) {
+                Point Q;
+                points[i].Get(&Q);
+                for (Point &T : pubkeys) {
+                    if (!Q.x.IsEqual(&T.x)) {
+                        continue;
+                    }
+                    Int key(&base);
+                    key.Add((uint64_t)i);
+                    if (!Q.y.IsEqual(&T.y)) {
+                        key.Neg();
+                        key.Add(&secp256k1->order);
+                    }
+                    report_found(key, secp256k1->GetPublicKeyHex(true, T), "");
+                    if (!multi_target) {
+                        print_elapsed_time(chrono_start);
+                        exit(0);
+                    }
+                }
+            }
+        }
+    };
+    
     auto hash_hunt = [&]() {
         
-        Int start, cores, width, r;
-        start.Set(&S_table[range_start]);
-        cores.SetInt32(cpuCores);
-        width.Set(&start);
-        width.Div(&cores, &r);
-        
-        vector<Int> start_points;
-        for (int i = 0; i < cpuCores; i++) {
-            start_points.push_back(start);
-            start.Add(&width);
+        // Range [2^(n-1),2^n) split in chunks, resumed from the checkpoint
+        // when it matches the range and target
+        Int range_begin, range_stop, chunk;
+        range_begin.Set(&S_table[range_start]);
+        range_stop.Add(&range_begin, &range_begin);
+        chunk.SetInt64(chunk_size);
+        Scheduler scheduler(&chunk);
+        Checkpoint checkpoint(checkpoint_file, range_end, target_hash);
+        vector<Int> starts, remainings;
+        if (checkpoint_interval > 0 && checkpoint.Load(starts, remainings)) {
+            print_time(); cout << "Resuming from " << checkpoint_file << " (" << starts.size() << " intervals)" << endl;
+            scheduler.Init(std::max(nb_threads, (int)starts.size()));
+            for (size_t i = 0; i < starts.size(); i++) {
+                scheduler.Set(i, &starts[i], &remainings[i]);
+            }
+        } else {
+            scheduler.Split(nb_threads, &range_begin, &range_stop);
         }
+        Int range_width;
+        range_width.Sub(&range_stop, &range_begin);
+        Reporter reporter(nb_threads, &range_width, &scheduler);
         
-        auto process_range = [&](int ThreadId, Int start_point, Int width_set) {
+        auto process_range = [&](int ThreadId) {
             
-            Int start, width, fin;
-            start.Set(&start_point);
-            width.Set(&width_set);
-            fin.Add(&start, &width);
-            unsigned char hash160[20];
-            string ripemd160;
-            Point P = secp256k1->ComputePublicKey(&start);
-
-            while (start.IsLower(&fin)) {
-
-                secp256k1->GetHash160(0, true, P, hash160);
-                ripemd160 = bytesToHexString(hash160);
-
-                if (ripemd160 == target_hash) {
-                    print_time(); cout << "Private key : " << start.GetBase10() << endl;
-                    ofstream outFile;
-                    outFile.open("found.txt", ios::app);
-                    outFile << start.GetBase10() << '\n';
-                    outFile.close();
-                    print_elapsed_time(chrono_start);
-                    exit(0);
+            Int start, length, fin, walk, priv;
+            walk.SetInt32(0);
+            uint64_t count = 0;
+            uint32_t sinceProgress = 0;
+            Point P;
+            AffinePoint keyBatch[HASH_BATCH_SIZE];
+            // P walks on FieldElement, stored in canonical form for the hash and compare
+            FieldElement px, py, gx, gy, deltaX, deltaY, slope, rx, ry;
+            gx.Set(&secp256k1->G.x);
+            gy.Set(&secp256k1->G.y);
+            unsigned char hashBatch[HASH_BATCH_SIZE * 20];
+            unsigned char scriptHashBatch[HASH_BATCH_SIZE * 20];
+
+            while (scheduler.NextChunk(ThreadId, &start, &length)) {
+
+                // P is already on start when this chunk follows the previous one
+                if (!start.IsEqual(&walk)) {
+                    secp256k1->ComputePublicKey(&start, &P);
+                    px.Set(&P.x);
+                    py.Set(&P.y);
+                }
+                fin.Add(&start, &length);
+
+                while (start.IsLower(&fin)) {
+
+                    // Walk up to HASH_BATCH_SIZE keys, then hash them together
+                    int nb = 0;
+                    priv.Set(&start);
+                    while (nb < HASH_BATCH_SIZE && start.IsLower(&fin)) {
+                        keyBatch[nb].Set(&px, &py);
+                        nb++;
+                        // P = P + G
+                        deltaX.Sub(&gx, &px);
+                        deltaX.Inv();
+                        deltaY.Sub(&gy, &py);
+                        slope.Mul(&deltaY, &deltaX);
+                        rx.Sqr(&slope);
+                        rx.Sub(&rx, &px);
+                        rx.Sub(&rx, &gx);
+                        ry.Sub(&px, &rx);
+                        ry.Mul(&slope);
+                        ry.Sub(&ry, &py);
+                        px.Set(&rx);
+                        py.Set(&ry);
+                        start.AddOne();
+                    }
+
+                    if (check_pubkey) {
+                        check_points(priv, keyBatch, nb);
+                    }
+                    if (check_compressed && (check_p2pkh || check_p2sh || check_bech32)) {
+                        secp256k1->GetHash160Batch(keyBatch, nb, true, hashBatch);
+                        if (check_p2pkh) {
+                            check_hashes(priv, hashBatch, nb, targets, "");
+                        }
+                        if (check_bech32) {
+                            check_hashes(priv, hashBatch, nb, bech32_targets, " bech32");
+                        }
+                        if (check_p2sh) {
+                            secp256k1->GetP2SHHash160Batch(hashBatch, nb, scriptHashBatch);
+                            check_hashes(priv, scriptHashBatch, nb, p2sh_targets, " p2sh");
+                        }
+                    }
+                    if (check_uncompressed && check_p2pkh) {
+                        secp256k1->GetHash160Batch(keyBatch, nb, false, hashBatch);
+                        check_hashes(priv, hashBatch, nb, targets, " uncompressed");
+                    }
+
+                    count += nb;
+                    sinceProgress += nb;
+                    if (sinceProgress > CHECKPOINT_KEY_MASK) {
+                        scheduler.Progress(ThreadId, &start);
+                        reporter.SetKeys(ThreadId, count);
+                        sinceProgress = 0;
+                    }
                 }
 
-                P = secp256k1->AddPoints(P, secp256k1->G);
-                start.AddOne();
+                reporter.SetKeys(ThreadId, count);
+                walk.Set(&start);
             }
             
         };
         
-        std::thread threads[cpuCores];
+        if (checkpoint_interval > 0) {
+            checkpoint.StartWriter(checkpoint_interval, &scheduler);
+        }
+        if (report_interval > 0) {
+            reporter.Start(report_interval);
+        }
+        
+        int nbWorker = nb_threads;
+        vector<std::thread> threads(nbWorker);
         
-        for (int i = 0; i < cpuCores; i++) {
-            threads[i] = std::thread(process_range, i, start_points[i], width);
+        for (int i = 0; i < nbWorker; i++) {
+            threads[i] = std::thread(process_range, i);
         }
         
-        for (int i = 0; i < cpuCores; i++) {
+        for (int i = 0; i < nbWorker; i++) {
             threads[i].join();
         }
+        
+        reporter.Stop();
+        checkpoint.StopWriter();
+        reporter.Summary(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - chrono_start).count());
     };
     
     print_time(); cout << "Hash Hunt in progress..." << endl;
@@ -118,4 +401,7 @@ auto main() -> int {
     std::thread thread(hash_hunt);
     
     thread.join();
+    
+    print_time(); cout << "Range scanned" << endl;
+    print_elapsed_time(chrono_start);
 }
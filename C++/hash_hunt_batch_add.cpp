@@ -3,16 +3,29 @@
 #include <vector>
 #include <thread>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
 
 #include "secp256k1/SECP256k1.h"
 #include "secp256k1/Int.h"
-#include "secp256k1/IntGroup.h"
+#include "secp256k1/FieldBatch.h"
+#include "hash/ripemd160.h"
 #include "util/util.h"
+#include "util/Scheduler.h"
+#include "util/Checkpoint.h"
+#include "util/Reporter.h"
+#include "target/TargetSet.h"
+#include "bsgs/BSGS.h"
+#include "kangaroo/Kangaroo.h"
+#include <sstream>
 
 using namespace std;
 
 const int cpuCores = std::thread::hardware_concurrency();
+const uint64_t CHUNK_SIZE = 1 << 20; // default keys per scheduler chunk
 const int POINTS_BATCH_SIZE = 1024;
+const int HALF_BATCH_SIZE = POINTS_BATCH_SIZE / 2;
 const char hex_chars[] = "0123456789abcdef";
 
 std::string bytesToHexString(const unsigned char* data) {
@@ -32,7 +45,7 @@ std::string bytesToHexString(const unsigned char* data) {
 
 auto main() -> int {
 
-    Secp256K1* secp256k1 = new Secp256K1(); secp256k1->Init();
+    Secp256K1* secp256k1 = new Secp256K1();
     
     Int pk; pk.SetInt32(1);
     uint64_t mult = 2;
@@ -49,137 +62,531 @@ auto main() -> int {
     ifstream inFile("settings.txt");
     getline(inFile, temp); range_end = std::stoull(temp);
     getline(inFile, temp); target_hash = trim(temp);
+    
+    // Optional "key = value" lines
+    string checkpoint_file = "checkpoint.txt", option, value;
+    int checkpoint_interval = 60;
+    int report_interval = 10;
+    string key_type = "compressed";
+    int nb_threads = cpuCores;
+    uint64_t chunk_size = CHUNK_SIZE;
+    string mode = "scan";
+    uint64_t bsgs_memory = 1024; // MB
+    int dp_bits = -1;
+    uint64_t kangaroo_memory = 1024; // MB
+    string kangaroo_file = "kangaroo.dat", kangaroo_merge;
+    int gtable_window = 8;
+    string gtable_cache;
+    string modinv = "drs62";
+    string field_simd = "auto";
+    while (getline(inFile, temp)) {
+        if (!parse_option(temp, option, value))
+            continue;
+        if (option == "checkpoint") {
+            checkpoint_file = value;
+        } else if (option == "checkpoint_interval") {
+            checkpoint_interval = std::stoi(value);
+        } else if (option == "key_type") {
+            key_type = value;
+        } else if (option == "report_interval") {
+            report_interval = std::stoi(value);
+        } else if (option == "threads") {
+            nb_threads = std::stoi(value);
+        } else if (option == "chunk_size") {
+            chunk_size = std::stoull(value);
+        } else if (option == "mode") {
+            mode = value;
+        } else if (option == "bsgs_memory") {
+            bsgs_memory = std::stoull(value);
+        } else if (option == "dp_bits") {
+            dp_bits = std::stoi(value);
+        } else if (option == "kangaroo_memory") {
+            kangaroo_memory = std::stoull(value);
+        } else if (option == "kangaroo_file") {
+            kangaroo_file = value;
+        } else if (option == "kangaroo_merge") {
+            kangaroo_merge = value;
+        } else if (option == "gtable_window") {
+            gtable_window = std::stoi(value);
+        } else if (option == "gtable_cache") {
+            gtable_cache = value;
+        } else if (option == "modinv") {
+            modinv = value;
+        } else if (option == "field_simd") {
+            field_simd = value;
+        } else {
+            print_time(); cout << "Unknown option : " << option << endl;
+        }
+    }
     inFile.close();
+    
+    // Processes sharing a cache file map its generator table instead of
+    // computing it
+    secp256k1->Init(gtable_cache);
+    // Modular inverse of the single key paths (AddPoints, Reduce, chunk starts),
+    // auto times them all and keeps the fastest on this CPU
+    if (modinv == "auto") {
+        Int::SelectModInv();
+    } else if (Int::GetModInvMethod(modinv) >= 0) {
+        Int::SetModInv(Int::GetModInvMethod(modinv));
+    } else {
+        print_time(); cout << "Invalid modinv " << modinv << " (auto, xcd, montgomery, penk, drs62 or safegcd62)" << endl;
+        return -1;
+    }
+    print_time(); cout << "ModInv      : " << Int::GetModInvName(Int::GetModInv()) << endl;
+    // Kernels of the batch additions, auto times the ones this CPU supports
+    if (field_simd != "auto" && !field_batch_set_kernels(field_simd)) {
+        print_time(); cout << "Invalid field_simd " << field_simd << " (auto, scalar, avx2, avx512 or ifma, as supported by this CPU)" << endl;
+        return -1;
+    }
+    const FieldBatchKernels *kernels = field_batch_kernels();
+    print_time(); cout << "Field SIMD  : " << kernels->name << " (" << kernels->lanes << (kernels->lanes > 1 ? " lanes)" : " lane)") << endl;
+    if (!gtable_cache.empty()) {
+        int source = secp256k1->GetGTableSource();
+        print_time(); cout << "GTable      : " << (source == GTABLE_MAPPED ? "mapped from " :
+                                                source == GTABLE_SAVED ? "computed, saved to " :
+                                                "computed, cannot write ") << gtable_cache << endl;
+    }
     range_start = range_end - (uint64_t)1;
+    if (nb_threads < 1) nb_threads = 1;
+    if (chunk_size < 1) chunk_size = 1;
+    // Whole batches per chunk
+    chunk_size = (chunk_size + POINTS_BATCH_SIZE - 1) / POINTS_BATCH_SIZE * POINTS_BATCH_SIZE;
     
     print_time(); cout << "Range Start : " << range_start << " bits" << endl;
     print_time(); cout << "Range End   : " << range_end << " bits" << endl;
-    print_time(); cout << "Target Hash : " << target_hash << endl;
+    bool check_compressed = (key_type == "compressed" || key_type == "both");
+    bool check_uncompressed = (key_type == "uncompressed" || key_type == "both");
+    if (!check_compressed && !check_uncompressed) {
+        print_time(); cout << "Invalid key_type " << key_type << " (compressed, uncompressed or both)" << endl;
+        return -1;
+    }
+    print_time(); cout << "Key Type    : " << key_type << endl;
+    print_time(); cout << "Threads     : " << nb_threads << " (" << chunk_size << " keys per chunk)" << endl;
+    // Wider generator windows, fewer additions per key for the BSGS and
+    // kangaroo starts
+    if (gtable_window != 8) {
+        if (gtable_window < 8 || gtable_window > 16) {
+            print_time(); cout << "Invalid gtable_window " << gtable_window << " (8 to 16)" << endl;
+            return -1;
+        }
+        secp256k1->SetGTableWindow(gtable_window);
+        print_time(); cout << "GTable      : " << gtable_window << " bits window" << endl;
+    }
+    
+    // A target that is not a hash160 or an address is a file holding one per line.
+    // P2SH-P2WPKH targets are matched on a second hash of the compressed key hash160,
+    // bech32 (P2WPKH) targets on the compressed key hash160 only.
+    // Known public keys are matched on the x coordinate of the points, without hashing.
+    TargetSet targets, p2sh_targets, bech32_targets, pubkey_targets;
+    uint8_t single_hash[20];
+    int single_type;
+    Point single_pubkey;
+    bool multi_target = !TargetSet::ParseTarget(target_hash, single_hash, &single_type);
+    bool check_p2pkh, check_p2sh, check_bech32, check_pubkey;
+    if (multi_target) {
+        if (!targets.LoadFile(target_hash) || !p2sh_targets.LoadFile(target_hash, P2SH) ||
+            !bech32_targets.LoadFile(target_hash, BECH32) ||
+            !pubkey_targets.LoadFile(target_hash, PUBKEY)) {
+            print_time(); cout << "Cannot open target file " << target_hash << endl;
+            return -1;
+        }
+        targets.Build();
+        p2sh_targets.Build();
+        bech32_targets.Build();
+        pubkey_targets.Build();
+        print_time(); cout << "Target File : " << target_hash << " (" << targets.GetSize() << " hashes, "
+                           << p2sh_targets.GetSize() << " p2sh, " << bech32_targets.GetSize() << " bech32, "
+                           << pubkey_targets.GetSize() << " pubkeys, "
+                           << (targets.GetFilterSize() + p2sh_targets.GetFilterSize() + bech32_targets.GetFilterSize() +
+                               pubkey_targets.GetFilterSize()) / 1024
+                           << " KB filter)" << endl;
+        if (targets.GetNbInvalid() > 0) {
+            print_time(); cout << "Skipped " << targets.GetNbInvalid() << " invalid lines" << endl;
+        }
+        check_p2pkh = targets.GetSize() > 0;
+        check_p2sh = p2sh_targets.GetSize() > 0;
+        check_bech32 = bech32_targets.GetSize() > 0;
+        check_pubkey = pubkey_targets.GetSize() > 0;
+    } else if (single_type == PUBKEY) {
+        bool isCompressed;
+        single_pubkey = secp256k1->ParsePublicKeyHex(target_hash, isCompressed);
+        print_time(); cout << "Target Key  : " << secp256k1->GetPublicKeyHex(true, single_pubkey) << " (pubkey)" << endl;
+        check_p2pkh = false;
+        check_p2sh = false;
+        check_bech32 = false;
+        check_pubkey = true;
+    } else {
+        const char *type_name[] = { "p2pkh", "p2sh", "bech32" };
+        if (target_hash.length() != 40) {
+            print_time(); cout << "Target Addr : " << target_hash << endl;
+        }
+        print_time(); cout << "Target Hash : " << bytesToHexString(single_hash) << " (" << type_name[single_type] << ")" << endl;
+        check_p2pkh = single_type == P2PKH;
+        check_p2sh = single_type == P2SH;
+        check_bech32 = single_type == BECH32;
+        check_pubkey = false;
+    }
+    if (check_p2sh && !check_compressed) {
+        print_time(); cout << "P2SH targets need compressed keys (key_type compressed or both)" << endl;
+        return -1;
+    }
+    if (check_bech32 && !check_compressed) {
+        print_time(); cout << "Bech32 targets need compressed keys (key_type compressed or both)" << endl;
+        return -1;
+    }
+
+    // Full points of the public key targets, for the y check of an x match
+    vector<Point> pubkeys;
+    if (check_pubkey) {
+        if (multi_target) {
+            TargetSet::LoadPublicKeys(target_hash, secp256k1, pubkeys);
+        } else {
+            pubkeys.push_back(single_pubkey);
+        }
+    }
+    
+    // Baby-step giant-step over the range for known public keys only
+    if (mode == "bsgs") {
+        if (!check_pubkey || check_p2pkh || check_p2sh || check_bech32) {
+            print_time(); cout << "BSGS mode needs public key targets only" << endl;
+            return -1;
+        }
+    } else if (mode == "kangaroo") {
+        if (multi_target || single_type != PUBKEY) {
+            print_time(); cout << "Kangaroo mode needs one public key target" << endl;
+            return -1;
+        }
+    } else if (mode != "scan") {
+        print_time(); cout << "Invalid mode " << mode << " (scan, bsgs or kangaroo)" << endl;
+        return -1;
+    }
+    print_time(); cout << "Mode        : " << mode << endl;
+    
+    std::mutex found_mutex;
+    auto report_found = [&](Int &key, std::string target, const char *suffix) {
+        std::lock_guard<std::mutex> lock(found_mutex);
+        print_time(); cout << "Private key : " << key.GetBase10() << suffix << endl;
+        ofstream outFile;
+        outFile.open("found.txt", ios::app);
+        if (multi_target) {
+            outFile << key.GetBase10() << ' ' << target << suffix << '\n';
+        } else {
+            outFile << key.GetBase10() << suffix << '\n';
+        }
+        outFile.close();
+    };
     
     auto chrono_start = std::chrono::high_resolution_clock::now();
     
+    // Test nb packed hash160 of the keys base, base+1, ... against the targets,
+    // the private key is only rebuilt from the batch index on a match
+    auto check_hashes = [&](Int &base, unsigned char *hashes, int nb, TargetSet &set, const char *kind) {
+        for (int i = 0; i < nb; i++) {
+            unsigned char *hash160 = hashes + 20 * i;
+            if (multi_target ? set.Contains(hash160) : ripemd160_comp_hash(hash160, single_hash)) {
+                Int key(&base);
+                key.Add((uint64_t)i);
+                report_found(key, bytesToHexString(hash160), kind);
+                if (!multi_target) {
+                    print_elapsed_time(chrono_start);
+                    exit(0);
+                }
+            }
+        }
+    };
+    
+    // Test the x coordinate of nb points of the keys base, base+1, ... against the
+    // known public keys. kG and -kG share x, the target point tells them apart by y :
+    // the key reported is the one of the target, written out with its public key.
+    auto check_points = [&](Int &base, AffinePoint *points, int nb) {
+        for (int i = 0; i < nb; i++) {
+            uint64_t *x = points[i].x;
+            if (multi_target ? pubkey_targets.Contains((uint8_t *)x)
+                             : x[0] == single_pubkey.x.bits64[0]) {
+                Point Q;
+                points[i].Get(&Q);
+                for (Point &T : pubkeys) {
+                    if (!Q.x.IsEqual(&T.x)) {
+                        continue;
+                    }
+                    Int key(&base);
+                    key.Add((uint64_t)i);
+                    if (!Q.y.IsEqual(&T.y)) {
+                        key.Neg();
+                        key.Add(&secp256k1->order);
+                    }
+                    report_found(key, secp256k1->GetPublicKeyHex(true, T), "");
+                    if (!multi_target) {
+                        print_elapsed_time(chrono_start);
+                        exit(0);
+                    }
+                }
+            }
+        }
+    };
+    
     auto hash_hunt = [&]() {
         
-        Int start, cores, keysPerThread, r, batch_size, nbBatch;
-        start.Set(&S_table[range_start]);
-        cores.SetInt32(cpuCores);
-        keysPerThread.Set(&start);
-        keysPerThread.Div(&cores, &r);
-        batch_size.SetInt32(POINTS_BATCH_SIZE);
+        // addPoints[i] = (i+1)G, the batch is walked from its centre in both
+        // directions so one inversion covers P+(i+1)G and P-(i+1)G. They come
+        // from the generator table with a single inversion, the last one is
+        // the jump POINTS_BATCH_SIZE*G.
+        Int addKeys[HALF_BATCH_SIZE + 1];
+        Point addPoints[HALF_BATCH_SIZE + 1];
+        for (int i = 0; i < HALF_BATCH_SIZE; i++)
+            addKeys[i].SetInt32(i + 1);
+        addKeys[HALF_BATCH_SIZE].SetInt32(POINTS_BATCH_SIZE);
+        secp256k1->ComputePublicKeyBatch(addKeys, HALF_BATCH_SIZE + 1, addPoints);
+        
+        // Range [2^(n-1),2^n) split in chunks, resumed from the checkpoint
+        // when it matches the range and target
+        Int range_begin, range_stop, range_width, chunk;
+        range_begin.Set(&S_table[range_start]);
+        range_stop.Add(&range_begin, &range_begin);
+        range_width.Sub(&range_stop, &range_begin);
+        chunk.SetInt64(chunk_size);
         
-        vector<Int> start_points;
-        for (int i = 0; i < cpuCores; i++) {
-            start_points.push_back(start);
-            start.Add(&keysPerThread);
+        // The BSGS chunks are whole rounds of giant steps
+        BSGS *bsgs = NULL;
+        if (mode == "bsgs") {
+            bsgs = new BSGS(secp256k1, pubkeys);
+            bsgs->Build(bsgs_memory << 20, &range_width, nb_threads);
+            bsgs->GetChunkSize(&chunk);
+            print_time(); cout << "BSGS        : " << bsgs->GetNbBaby() << " baby steps (" << (bsgs->GetTableSize() >> 20)
+                               << " MB), giant step " << bsgs->GetGiantStep() << ", " << pubkeys.size() << " pubkeys" << endl;
         }
-
-        Point addPoints[POINTS_BATCH_SIZE];
-        Point batch_Add = secp256k1->DoubleDirect(secp256k1->G);
-        addPoints[0] = secp256k1->G;
-        addPoints[1] = batch_Add;
-        for (int i = 2; i < POINTS_BATCH_SIZE; i++)
-        {
-            batch_Add = secp256k1->AddPoints(batch_Add, secp256k1->G);
-            addPoints[i] = batch_Add;
+        Scheduler scheduler(&chunk);
+        Checkpoint checkpoint(checkpoint_file, range_end, target_hash);
+        vector<Int> starts, remainings;
+        if (checkpoint_interval > 0 && checkpoint.Load(starts, remainings)) {
+            print_time(); cout << "Resuming from " << checkpoint_file << " (" << starts.size() << " intervals)" << endl;
+            scheduler.Init(std::max(nb_threads, (int)starts.size()));
+            for (size_t i = 0; i < starts.size(); i++) {
+                scheduler.Set(i, &starts[i], &remainings[i]);
+            }
+        } else {
+            scheduler.Split(nb_threads, &range_begin, &range_stop);
+        }
+        Reporter reporter(nb_threads, &range_width, &scheduler);
+        if (bsgs) {
+            reporter.SetKeysPerCount(bsgs->GetGiantStep());
         }
         
-        nbBatch.Set(&keysPerThread);
-        nbBatch.Div(&batch_size, &r); 
-        
-        auto process_range = [&](int ThreadId, Int start_point, Int batch_count, Int batchSize) {
-            
-            Int start, batch_num;
-            start.Set(&start_point);
-            batch_num.Set(&batch_count);
-
-            unsigned char hash160[20];
-            string ripemd160;
-
-            IntGroup modGroup(POINTS_BATCH_SIZE);
-            Int deltaX[POINTS_BATCH_SIZE];
-            modGroup.Set(deltaX);
-            Int pointBatchX[POINTS_BATCH_SIZE];
-            Int pointBatchY[POINTS_BATCH_SIZE];
-            Int deltaY, slope;
-                      
-            Point startPoint = secp256k1->ComputePublicKey(&start);
-            startPoint = secp256k1->SubtractPoints(startPoint, secp256k1->G);
+        auto process_range = [&](int ThreadId) {
             
-            Point P;
-            Int priv_keys[POINTS_BATCH_SIZE];
-            Int priv;
+            if (bsgs) {
+                bsgs->Search(ThreadId, &scheduler, &reporter, [&](Int &key, int target) {
+                    report_found(key, secp256k1->GetPublicKeyHex(true, pubkeys[target]), "");
+                    if (!multi_target) {
+                        print_elapsed_time(chrono_start);
+                        exit(0);
+                    }
+                });
+                return;
+            }
             
-            while (!batch_num.IsZero()) {
+            Int start, length, walk;
+            walk.SetInt32(0);
+            uint64_t count = 0;
 
-                priv.Set(&start);
-                for (int i = 0; i < POINTS_BATCH_SIZE; i++) {
-                    priv_keys[i] = priv;
-                    priv.AddOne();
-                }
+            unsigned char hashBatch[POINTS_BATCH_SIZE * 20];
+            unsigned char scriptHashBatch[POINTS_BATCH_SIZE * 20];
 
+            // The batch formulas run on the FieldBatch kernels, a few points per
+            // instruction, the points are stored in canonical form for the hash
+            // and compare. The last add point is the jump to the next centre.
+            FieldBatch addX(HALF_BATCH_SIZE + 1), addY(HALF_BATCH_SIZE + 1);
+            for (int i = 0; i <= HALF_BATCH_SIZE; i++) {
+                addX.Set(i, &addPoints[i].x);
+                addY.Set(i, &addPoints[i].y);
+            }
 
-                for (int i = 0; i < POINTS_BATCH_SIZE; i++) {
-                    deltaX[i].ModSub(&startPoint.x, &addPoints[i].x);
+            FieldBatch deltaX(HALF_BATCH_SIZE + 1), prefix(HALF_BATCH_SIZE + 1);
+            FieldBatch plusX(HALF_BATCH_SIZE + 1), plusY(HALF_BATCH_SIZE + 1);
+            FieldBatch minusX(HALF_BATCH_SIZE + 1), minusY(HALF_BATCH_SIZE + 1);
+            AffinePoint pointBatch[POINTS_BATCH_SIZE];
+            FieldElement ex, ey;
+            
+            Point startPoint;
+            FieldElement startX, startY;
+            Int centre;
+            
+            while (scheduler.NextChunk(ThreadId, &start, &length)) {
+                // startPoint is the centre of the batch : start + HALF_BATCH_SIZE,
+                // it is already there when this chunk follows the previous one
+                if (!start.IsEqual(&walk)) {
+                    centre.Set(&start);
+                    centre.Add((uint64_t)HALF_BATCH_SIZE);
+                    secp256k1->ComputePublicKey(&centre, &startPoint);
+                    startX.Set(&startPoint.x);
+                    startY.Set(&startPoint.y);
                 }
-    
-                modGroup.ModInv();
-                
-                for (int i = 0; i < POINTS_BATCH_SIZE; i++) {
-                    
-                    deltaY.ModSub(&startPoint.y, &addPoints[i].y);
-                    slope.ModMulK1(&deltaY, &deltaX[i]);
 
-                    pointBatchX[i].ModSquareK1(&slope);
-                    pointBatchX[i].ModSub(&pointBatchX[i], &startPoint.x);
-                    pointBatchX[i].ModSub(&pointBatchX[i], &addPoints[i].x);
+                // Chunk length fits in 64 bits, the last batch may be partial
+                uint64_t nbKeys = length.bits64[0];
 
-                    pointBatchY[i].ModSub(&startPoint.x, &pointBatchX[i]);
-                    pointBatchY[i].ModMulK1(&slope, &pointBatchY[i]);
-                    pointBatchY[i].ModSub(&pointBatchY[i], &startPoint.y);
+                for (uint64_t done = 0; done < nbKeys; done += POINTS_BATCH_SIZE) {
 
-                }
-                
+                    kernels->AddPoints(&startX, &startY, &addX, &addY, HALF_BATCH_SIZE + 1, &deltaX, &prefix,
+                                       &plusX, &plusY, &minusX, &minusY);
 
-                for (int i = 0; i < POINTS_BATCH_SIZE; i++) {
+                    pointBatch[HALF_BATCH_SIZE].Set(&startX, &startY);
 
-                    P.x.Set(&pointBatchX[i]);
-                    P.y.Set(&pointBatchY[i]);
-                    secp256k1->GetHash160(0, true, P, hash160);
-                    ripemd160 = bytesToHexString(hash160);
+                    // startPoint + (i+1)G, the last one belongs to the next batch,
+                    // and startPoint - (i+1)G
+                    for (int i = 0; i < HALF_BATCH_SIZE; i++) {
+                        if (i < HALF_BATCH_SIZE - 1) {
+                            plusX.Get(i, &ex);
+                            plusY.Get(i, &ey);
+                            pointBatch[HALF_BATCH_SIZE + 1 + i].Set(&ex, &ey);
+                        }
+                        minusX.Get(i, &ex);
+                        minusY.Get(i, &ey);
+                        pointBatch[HALF_BATCH_SIZE - 1 - i].Set(&ex, &ey);
+                    }
 
-                    if (ripemd160 == target_hash) {
-                        print_time(); cout << "Private key : " << priv_keys[i].GetBase10() << endl;
-                        ofstream outFile;
-                        outFile.open("found.txt", ios::app);
-                        outFile << priv_keys[i].GetBase10() << '\n';
-                        outFile.close();
-                        print_elapsed_time(chrono_start);
-                        exit(0);
+                    int nbCheck = (nbKeys - done < POINTS_BATCH_SIZE) ? (int)(nbKeys - done) : POINTS_BATCH_SIZE;
+                    if (check_pubkey) {
+                        check_points(start, pointBatch, nbCheck);
                     }
+                    if (check_compressed && (check_p2pkh || check_p2sh || check_bech32)) {
+                        secp256k1->GetHash160Batch(pointBatch, nbCheck, true, hashBatch);
+                        if (check_p2pkh) {
+                            check_hashes(start, hashBatch, nbCheck, targets, "");
+                        }
+                        if (check_bech32) {
+                            check_hashes(start, hashBatch, nbCheck, bech32_targets, " bech32");
+                        }
+                        if (check_p2sh) {
+                            secp256k1->GetP2SHHash160Batch(hashBatch, nbCheck, scriptHashBatch);
+                            check_hashes(start, scriptHashBatch, nbCheck, p2sh_targets, " p2sh");
+                        }
+                    }
+                    if (check_uncompressed && check_p2pkh) {
+                        secp256k1->GetHash160Batch(pointBatch, nbCheck, false, hashBatch);
+                        check_hashes(start, hashBatch, nbCheck, targets, " uncompressed");
+                    }
+
+                    count += nbCheck;
+                    reporter.SetKeys(ThreadId, count);
+
+                    // Next centre : startPoint + POINTS_BATCH_SIZE*G
+                    plusX.Get(HALF_BATCH_SIZE, &startX);
+                    plusY.Get(HALF_BATCH_SIZE, &startY);
+                    start.Add((uint64_t)POINTS_BATCH_SIZE);
+                    scheduler.Progress(ThreadId, &start);
                 }
-                
-                startPoint.x.Set(&pointBatchX[POINTS_BATCH_SIZE - 1]);
-                startPoint.y.Set(&pointBatchY[POINTS_BATCH_SIZE - 1]);
-                batch_num.SubOne();
-                start.Add(&batchSize);
+
+                walk.Set(&start);
             }
             
         };
         
-        std::thread threads[cpuCores];
+        if (checkpoint_interval > 0) {
+            checkpoint.StartWriter(checkpoint_interval, &scheduler);
+        }
+        if (report_interval > 0) {
+            reporter.Start(report_interval);
+        }
+        
+        int nbWorker = nb_threads;
+        vector<std::thread> threads(nbWorker);
+        
+        for (int i = 0; i < nbWorker; i++) {
+            threads[i] = std::thread(process_range, i);
+        }
+        
+        for (int i = 0; i < nbWorker; i++) {
+            threads[i].join();
+        }
+        
+        reporter.Stop();
+        checkpoint.StopWriter();
+        reporter.Summary(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - chrono_start).count());
+        delete bsgs;
+    };
+    
+    // Pollard kangaroo over the whole range, the workers only return when the
+    // key is found. The DP table is saved every checkpoint_interval to
+    // kangaroo_file, reloaded on start with the files of kangaroo_merge.
+    auto kangaroo_hunt = [&]() {
+        
+        Int range_begin, range_width;
+        range_begin.Set(&S_table[range_start]);
+        range_width.Set(&range_begin);
+        Kangaroo kangaroo(secp256k1, single_pubkey, (int)range_end, &range_begin, &range_width);
+        kangaroo.Init(dp_bits, kangaroo_memory << 20, nb_threads);
+        print_time(); cout << "Kangaroo    : " << nb_threads * KANGAROO_HERD << " kangaroos, DP bits " << kangaroo.GetDPBits()
+                           << ", table " << (kangaroo.GetTable()->GetMemory() >> 20) << " MB" << endl;
+        
+        // Several workers can resolve a collision before exit, only the
+        // first one reports the key
+        std::atomic<bool> key_found(false);
+        auto found = [&](Int &key) {
+            if (key_found.exchange(true))
+                return;
+            report_found(key, secp256k1->GetPublicKeyHex(true, single_pubkey), "");
+            print_elapsed_time(chrono_start);
+            exit(0);
+        };
+        
+        vector<string> files;
+        if (checkpoint_interval > 0) {
+            files.push_back(kangaroo_file);
+        }
+        std::stringstream merge(kangaroo_merge);
+        while (getline(merge, temp, ',')) {
+            files.push_back(trim(temp));
+        }
+        for (size_t i = 0; i < files.size(); i++) {
+            uint64_t nbLoaded;
+            if (kangaroo.Merge(files[i], found, &nbLoaded)) {
+                print_time(); cout << "Loaded " << nbLoaded << " DPs from " << files[i] << endl;
+            } else if (i > 0 || checkpoint_interval == 0) {
+                print_time(); cout << "Cannot read DP file " << files[i] << " (missing or other range/target)" << endl;
+            }
+        }
+        
+        // Progress against the expected number of jumps
+        double expected_ops = kangaroo.GetExpectedOps();
+        int shift = std::max(0, std::ilogb(expected_ops) - 62);
+        Int expected;
+        expected.SetInt64((uint64_t)std::ldexp(expected_ops, -shift));
+        expected.ShiftL(shift);
+        Reporter reporter(nb_threads, &expected, NULL);
+        if (report_interval > 0) {
+            reporter.Start(report_interval);
+        }
         
-        for (int i = 0; i < cpuCores; i++) {
-            threads[i] = std::thread(process_range, i, start_points[i], nbBatch, batch_size);
+        vector<std::thread> threads(nb_threads);
+        for (int i = 0; i < nb_threads; i++) {
+            threads[i] = std::thread([&kangaroo, &reporter, &found, i]() { kangaroo.Search(i, &reporter, found); });
         }
         
-        for (int i = 0; i < cpuCores; i++) {
+        while (checkpoint_interval > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(checkpoint_interval));
+            if (!kangaroo.Save(kangaroo_file)) {
+                print_time(); cout << "Cannot write " << kangaroo_file << endl;
+            }
+        }
+        
+        for (int i = 0; i < nb_threads; i++) {
             threads[i].join();
         }
     };
     
     print_time(); cout << "Hash Hunt in progress..." << endl;
     
-    std::thread thread(hash_hunt);
+    std::thread thread;
+    if (mode == "kangaroo") {
+        thread = std::thread(kangaroo_hunt);
+    } else {
+        thread = std::thread(hash_hunt);
+    }
     
     thread.join();
+    
+    print_time(); cout << "Range scanned" << endl;
+    print_elapsed_time(chrono_start);
 }
@@ -0,0 +1,182 @@
+#include "DPTable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#ifdef WIN64
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define DP_READY (1ULL << 63)
+#define DP_HERD  (1ULL << 62)
+#define DP_DIST_MASK (DP_HERD - 1)
+
+DPTable::DPTable() {
+  entries = NULL;
+  capacity = 0;
+  maxEntry = 0;
+  nbEntry = 0;
+}
+
+DPTable::~DPTable() {
+  free(entries);
+}
+
+void DPTable::Init(uint64_t capacity) {
+
+  uint64_t c = 1024;
+  while (c < capacity)
+    c <<= 1;
+  this->capacity = c;
+  maxEntry = c / 8 * 7;
+  nbEntry = 0;
+  free(entries);
+  // Untouched pages of a large table are never mapped
+  entries = (Entry *)calloc(c, sizeof(Entry));
+
+}
+
+uint64_t DPTable::GetNbEntry() {
+  return __atomic_load_n(&nbEntry, __ATOMIC_RELAXED);
+}
+
+uint64_t DPTable::GetCapacity() {
+  return capacity;
+}
+
+uint64_t DPTable::GetMemory() {
+  return capacity * sizeof(Entry);
+}
+
+int DPTable::Add(uint64_t x, Int *dist, int herd, Int *otherDist) {
+
+  if (x == 0)
+    x = 1;
+  uint64_t mask = capacity - 1;
+  uint64_t p = x & mask;
+
+  while (true) {
+
+    Entry *e = entries + p;
+    uint64_t cur = __atomic_load_n(&e->x, __ATOMIC_ACQUIRE);
+
+    if (cur == 0) {
+      if (__atomic_load_n(&nbEntry, __ATOMIC_RELAXED) >= maxEntry)
+        return DP_FULL;
+      if (__atomic_compare_exchange_n(&e->x, &cur, x, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        e->dist[0] = dist->bits64[0];
+        e->dist[1] = dist->bits64[1];
+        __atomic_store_n(&e->dist[2], (dist->bits64[2] & DP_DIST_MASK) | (herd ? DP_HERD : 0) | DP_READY, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&nbEntry, 1, __ATOMIC_RELAXED);
+        return DP_ADDED;
+      }
+      // Claimed meanwhile, cur is the new x
+    }
+
+    if (cur == x) {
+      uint64_t d2;
+      while (!((d2 = __atomic_load_n(&e->dist[2], __ATOMIC_ACQUIRE)) & DP_READY))
+        ;
+      otherDist->SetInt32(0);
+      otherDist->bits64[0] = e->dist[0];
+      otherDist->bits64[1] = e->dist[1];
+      otherDist->bits64[2] = d2 & DP_DIST_MASK;
+      return (((d2 & DP_HERD) != 0) == (herd != 0)) ? DP_SAME_HERD : DP_COLLISION;
+    }
+
+    p = (p + 1) & mask;
+
+  }
+
+}
+
+bool DPTable::Save(std::string fileName, std::string header) {
+
+  std::string tmpName = fileName + ".tmp";
+  FILE *f = fopen(tmpName.c_str(), "wb");
+  if (f == NULL)
+    return false;
+
+  header += '\n';
+  bool ok = fwrite(header.data(), 1, header.length(), f) == header.length();
+
+  // Entries being written are skipped, they go in the next save
+  std::vector<Entry> buffer;
+  buffer.reserve(4096);
+  for (uint64_t i = 0; ok && i < capacity; i++) {
+    Entry *e = entries + i;
+    uint64_t x = __atomic_load_n(&e->x, __ATOMIC_ACQUIRE);
+    if (x == 0)
+      continue;
+    uint64_t d2 = __atomic_load_n(&e->dist[2], __ATOMIC_ACQUIRE);
+    if (!(d2 & DP_READY))
+      continue;
+    Entry c;
+    c.x = x;
+    c.dist[0] = e->dist[0];
+    c.dist[1] = e->dist[1];
+    c.dist[2] = d2;
+    buffer.push_back(c);
+    if (buffer.size() == 4096) {
+      ok = fwrite(buffer.data(), sizeof(Entry), buffer.size(), f) == buffer.size();
+      buffer.clear();
+    }
+  }
+  if (ok && buffer.size() > 0)
+    ok = fwrite(buffer.data(), sizeof(Entry), buffer.size(), f) == buffer.size();
+
+  ok = ok && fflush(f) == 0;
+#ifdef WIN64
+  ok = ok && _commit(_fileno(f)) == 0;
+#else
+  ok = ok && fsync(fileno(f)) == 0;
+#endif
+  fclose(f);
+  if (!ok) {
+    remove(tmpName.c_str());
+    return false;
+  }
+#ifdef WIN64
+  remove(fileName.c_str());
+#endif
+  return rename(tmpName.c_str(), fileName.c_str()) == 0;
+
+}
+
+bool DPTable::Load(std::string fileName, std::string header, CollisionCallback collision, uint64_t *nbLoaded) {
+
+  *nbLoaded = 0;
+  FILE *f = fopen(fileName.c_str(), "rb");
+  if (f == NULL)
+    return false;
+
+  char line[512];
+  if (fgets(line, sizeof(line), f) == NULL || header + '\n' != line) {
+    fclose(f);
+    return false;
+  }
+
+  Entry e;
+  Int dist, other;
+  while (fread(&e, sizeof(Entry), 1, f) == 1) {
+    dist.SetInt32(0);
+    dist.bits64[0] = e.dist[0];
+    dist.bits64[1] = e.dist[1];
+    dist.bits64[2] = e.dist[2] & DP_DIST_MASK;
+    int herd = (e.dist[2] & DP_HERD) ? DP_WILD : DP_TAME;
+    int r = Add(e.x, &dist, herd, &other);
+    if (r == DP_COLLISION) {
+      if (herd == DP_TAME)
+        collision(&dist, &other);
+      else
+        collision(&other, &dist);
+    }
+    (*nbLoaded)++;
+  }
+  fclose(f);
+
+  return true;
+
+}
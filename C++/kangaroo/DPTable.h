@@ -0,0 +1,61 @@
+#ifndef DPTABLEH
+#define DPTABLEH
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+#include "../secp256k1/Int.h"
+
+#define DP_TAME 0
+#define DP_WILD 1
+
+// Add() results
+#define DP_ADDED     0
+#define DP_FULL      1  // Not stored, the table is at its load limit
+#define DP_SAME_HERD 2  // Same point reached twice by a herd, the walk is dead
+#define DP_COLLISION 3  // Tame and wild met, the key follows from the distances
+
+// Lock-free table of the distinguished points of a kangaroo run.
+// An entry is 32 bytes: x is the second limb of the point x (never 0, 0 marks
+// an empty slot), then the 192-bit travelled distance whose top bits hold
+// the herd and a ready flag. A slot is claimed with a CAS on x, the distance
+// is published by the release store of its last word.
+class DPTable {
+
+public:
+
+  typedef std::function<void(Int *tameDist, Int *wildDist)> CollisionCallback;
+
+  DPTable();
+  ~DPTable();
+
+  // capacity is rounded up to a power of 2, at most 7/8 of it is filled
+  void Init(uint64_t capacity);
+
+  // otherDist is the distance of the entry met on DP_SAME_HERD and DP_COLLISION
+  int Add(uint64_t x, Int *dist, int herd, Int *otherDist);
+
+  uint64_t GetNbEntry();
+  uint64_t GetCapacity();
+  uint64_t GetMemory();
+
+  // File is a text header line followed by the raw entries. Load adds the
+  // entries of a file with the same header, collisions are reported.
+  bool Save(std::string fileName, std::string header);
+  bool Load(std::string fileName, std::string header, CollisionCallback collision, uint64_t *nbLoaded);
+
+private:
+
+  struct Entry {
+    uint64_t x;
+    uint64_t dist[3];
+  };
+
+  Entry *entries;
+  uint64_t capacity;
+  uint64_t maxEntry;
+  uint64_t nbEntry;
+
+};
+
+#endif // DPTABLEH
@@ -0,0 +1,281 @@
+#include "Kangaroo.h"
+#include <vector>
+#include <math.h>
+#include <iostream>
+#include "../util/util.h"
+#include "../secp256k1/IntGroup.h"
+
+Kangaroo::Kangaroo(Secp256K1 *secp, Point &target, int rangeBits, Int *rangeStart, Int *rangeWidth) {
+
+  this->secp = secp;
+  this->target = target;
+  this->rangeBits = rangeBits;
+  this->rangeStart.Set(rangeStart);
+  this->rangeWidth.Set(rangeWidth);
+  nbThread = 1;
+  dpBits = 0;
+  dpMask = 0;
+  tableFull = false;
+
+  // Q' = Q - aG, Q = +-aG is left to Search (k' = 0 has no point)
+  Point C;
+  secp->ComputePublicKey(rangeStart, &C);
+  if (C.x.IsEqual(&target.x)) {
+    wildStart = secp->G;
+  } else {
+    C.y.ModNeg();
+    secp->AddPointsInto(&wildStart, this->target, C);
+  }
+
+}
+
+void Kangaroo::Init(int dpBits, uint64_t memory, int nbThread) {
+
+  this->nbThread = nbThread;
+  int widthBits = rangeBits - 1;
+  int nbKangaroo = nbThread * KANGAROO_HERD;
+
+  // N kangaroos walk about N*2^dp jumps past their last DP, keep it small
+  // against sqrt(w)
+  if (dpBits < 0) {
+    dpBits = widthBits / 2 - (int)log2((double)nbKangaroo) - 3;
+    if (dpBits < 0)
+      dpBits = 0;
+  }
+  if (dpBits > 60)
+    dpBits = 60;
+  this->dpBits = dpBits;
+  dpMask = dpBits ? ~0ULL << (64 - dpBits) : 0;
+
+  // Jump distances in [1,2^(w/2+1)), mean sqrt(w), from a fixed seed
+  std::mt19937_64 rng((uint64_t)rangeBits);
+  int jumpBits = widthBits / 2 + 1;
+  for (int j = 0; j < KANGAROO_NB_JUMP; j++) {
+    Int &d = jumpDist[j];
+    do {
+      d.SetInt32(0);
+      for (int i = 0; i * 64 < jumpBits; i++)
+        d.bits64[i] = rng();
+      if (jumpBits % 64)
+        d.bits64[jumpBits / 64] &= (1ULL << (jumpBits % 64)) - 1;
+    } while (d.IsZero());
+    secp->ComputePublicKey(&d, &jumpPoint[j]);
+  }
+
+  uint64_t nbSlot = (uint64_t)(4.0 * GetExpectedOps() / ldexp(1.0, dpBits));
+  if (nbSlot > memory / 32)
+    nbSlot = memory / 32;
+  table.Init(nbSlot);
+
+}
+
+int Kangaroo::GetDPBits() {
+  return dpBits;
+}
+
+double Kangaroo::GetExpectedOps() {
+  return 2.0 * sqrt(rangeWidth.ToDouble()) + (double)nbThread * KANGAROO_HERD * ldexp(1.0, dpBits);
+}
+
+DPTable *Kangaroo::GetTable() {
+  return &table;
+}
+
+std::string Kangaroo::GetHeader() {
+  return "kangaroo " + std::to_string(rangeBits) + " " + secp->GetPublicKeyHex(true, target);
+}
+
+bool Kangaroo::Save(std::string fileName) {
+  return table.Save(fileName, GetHeader());
+}
+
+bool Kangaroo::Merge(std::string fileName, FoundCallback found, uint64_t *nbLoaded) {
+  return table.Load(fileName, GetHeader(), [&](Int *tameDist, Int *wildDist) {
+    Collide(tameDist, wildDist, found);
+  }, nbLoaded);
+}
+
+bool Kangaroo::CheckKey(Int &key, FoundCallback &found) {
+  while (key.IsNegative())
+    key.Add(&secp->order);
+  Point P;
+  secp->ComputePublicKey(&key, &P);
+  if (P.x.IsEqual(&target.x) && P.y.IsEqual(&target.y)) {
+    found(key);
+    return true;
+  }
+  return false;
+}
+
+// Same x for a tame at dT G and a wild at Q' + dW G : k' = dT - dW, or
+// -(dT + dW) when the points are opposite
+void Kangaroo::Collide(Int *tameDist, Int *wildDist, FoundCallback &found) {
+
+  Int key(&rangeStart);
+  key.Add(tameDist);
+  key.Sub(wildDist);
+  if (CheckKey(key, found))
+    return;
+  key.Set(&rangeStart);
+  key.Sub(tameDist);
+  key.Sub(wildDist);
+  CheckKey(key, found);
+
+}
+
+// Random distance in [1,w)
+void Kangaroo::RandomDist(Int *dist, std::mt19937_64 &rng) {
+
+  int widthBits = rangeWidth.GetBitLength();
+  do {
+    dist->SetInt32(0);
+    for (int i = 0; i * 64 < widthBits; i++)
+      dist->bits64[i] = rng();
+    if (widthBits % 64)
+      dist->bits64[widthBits / 64] &= (1ULL << (widthBits % 64)) - 1;
+  } while (dist->IsZero() || !dist->IsLower(&rangeWidth));
+
+}
+
+// New kangaroo at a random distance in [0,w)
+void Kangaroo::Spawn(int herd, Int *dist, Point &P, std::mt19937_64 &rng, FoundCallback &found) {
+
+  while (true) {
+
+    RandomDist(dist, rng);
+    secp->ComputePublicKey(dist, &P);
+    if (herd == DP_TAME)
+      return;
+
+    if (!P.x.IsEqual(&wildStart.x)) {
+      secp->AddPointsInto(&P, wildStart, P);
+      return;
+    }
+    // Q' = +-dG
+    Int key(&rangeStart);
+    key.Add(dist);
+    CheckKey(key, found);
+
+  }
+
+}
+
+void Kangaroo::Search(int thread, Reporter *reporter, FoundCallback found) {
+
+  Point C;
+  secp->ComputePublicKey(&rangeStart, &C);
+  if (C.x.IsEqual(&target.x)) {
+    Int key(&rangeStart);
+    if (CheckKey(key, found))
+      return;
+  }
+
+  std::random_device rd;
+  std::mt19937_64 rng(((uint64_t)rd() << 32) ^ rd() ^ (uint64_t)thread);
+
+  std::vector<Point> P(KANGAROO_HERD);
+  std::vector<Int> dist(KANGAROO_HERD);
+  std::vector<Int> deltaX(KANGAROO_HERD);
+  std::vector<int> jump(KANGAROO_HERD);
+  std::vector<bool> respawn(KANGAROO_HERD);
+  IntGroup modGroup(KANGAROO_HERD);
+  modGroup.Set(deltaX.data());
+  Int deltaY, slope, rx, ry, other;
+
+  // Even kangaroos are tame, odd ones wild. The whole herd starts with one
+  // inversion for the dG and one for the Q' + dG of the wild ones.
+  for (int i = 0; i < KANGAROO_HERD; i++)
+    RandomDist(&dist[i], rng);
+  secp->ComputePublicKeyBatch(dist.data(), KANGAROO_HERD, P.data());
+  for (int i = 0; i < KANGAROO_HERD; i++) {
+    deltaX[i].SetInt32(1);
+    if (i & 1)
+      deltaX[i].ModSub(&P[i].x, &wildStart.x);
+    respawn[i] = deltaX[i].IsZero();
+    if (respawn[i])
+      deltaX[i].SetInt32(1);
+  }
+  modGroup.ModInv();
+  for (int i = 1; i < KANGAROO_HERD; i += 2) {
+    if (respawn[i]) {
+      Spawn(DP_WILD, &dist[i], P[i], rng, found);
+      continue;
+    }
+    deltaY.ModSub(&P[i].y, &wildStart.y);
+    slope.ModMulK1(&deltaY, &deltaX[i]);
+    rx.ModSquareK1(&slope);
+    rx.ModSub(&rx, &P[i].x);
+    rx.ModSub(&rx, &wildStart.x);
+    ry.ModSub(&P[i].x, &rx);
+    ry.ModMulK1(&slope, &ry);
+    ry.ModSub(&ry, &P[i].y);
+    P[i].x.Set(&rx);
+    P[i].y.Set(&ry);
+  }
+
+  uint64_t count = 0;
+  while (true) {
+
+    for (int i = 0; i < KANGAROO_HERD; i++) {
+      jump[i] = (int)(P[i].x.bits64[0] & (KANGAROO_NB_JUMP - 1));
+      deltaX[i].ModSub(&jumpPoint[jump[i]].x, &P[i].x);
+      // P = +-jump point, started again after the round
+      respawn[i] = deltaX[i].IsZero();
+      if (respawn[i])
+        deltaX[i].SetInt32(1);
+    }
+
+    modGroup.ModInv();
+
+    for (int i = 0; i < KANGAROO_HERD; i++) {
+
+      if (respawn[i])
+        continue;
+      Point &J = jumpPoint[jump[i]];
+
+      deltaY.ModSub(&J.y, &P[i].y);
+      slope.ModMulK1(&deltaY, &deltaX[i]);
+      rx.ModSquareK1(&slope);
+      rx.ModSub(&rx, &P[i].x);
+      rx.ModSub(&rx, &J.x);
+      ry.ModSub(&P[i].x, &rx);
+      ry.ModMulK1(&slope, &ry);
+      ry.ModSub(&ry, &P[i].y);
+      P[i].x.Set(&rx);
+      P[i].y.Set(&ry);
+      dist[i].Add(&jumpDist[jump[i]]);
+
+      if ((P[i].x.bits64[3] & dpMask) == 0) {
+        int herd = i & 1;
+        switch (table.Add(P[i].x.bits64[1], &dist[i], herd, &other)) {
+        case DP_COLLISION:
+          if (herd == DP_TAME)
+            Collide(&dist[i], &other, found);
+          else
+            Collide(&other, &dist[i], found);
+          respawn[i] = true;
+          break;
+        case DP_SAME_HERD:
+          // Follows the path of an other kangaroo of its herd from here
+          respawn[i] = true;
+          break;
+        case DP_FULL:
+          if (!tableFull.exchange(true)) {
+            print_time(); std::cout << "DP table full, new DPs are dropped (raise kangaroo_memory or dp_bits)" << std::endl;
+          }
+          break;
+        }
+      }
+
+    }
+
+    for (int i = 0; i < KANGAROO_HERD; i++)
+      if (respawn[i])
+        Spawn(i & 1, &dist[i], P[i], rng, found);
+
+    count += KANGAROO_HERD;
+    reporter->SetKeys(thread, count);
+
+  }
+
+}
@@ -0,0 +1,73 @@
+#ifndef KANGAROOH
+#define KANGAROOH
+
+#include <stdint.h>
+#include <string>
+#include <random>
+#include <functional>
+#include <atomic>
+#include "../secp256k1/SECP256k1.h"
+#include "../util/Reporter.h"
+#include "DPTable.h"
+
+#define KANGAROO_NB_JUMP 32    // Jump table size, power of 2
+#define KANGAROO_HERD    1024  // Kangaroos per thread (half tame, half wild), one inversion per jump
+
+// Pollard kangaroo search of one public key Q in [a,a+w).
+// The key is searched as k' = k-a for Q' = Q - aG. Tame kangaroos start at
+// dG and wild ones at Q' + dG, d random in [0,w), and jump by the distances
+// of a table chosen by x. The jump table only depends on the range bits so
+// runs of the same range and target walk the same paths and can be merged.
+// A point is distinguished when the top dpBits bits of x are 0, it is stored
+// with its distance in a DPTable where a tame and a wild with the same x give
+// the key.
+class Kangaroo {
+
+public:
+
+  typedef std::function<void(Int &key)> FoundCallback;
+
+  Kangaroo(Secp256K1 *secp, Point &target, int rangeBits, Int *rangeStart, Int *rangeWidth);
+
+  // dpBits < 0 selects it from the range and the number of kangaroos. The
+  // table is sized for 4 times the expected DPs, at most memory bytes.
+  void Init(int dpBits, uint64_t memory, int nbThread);
+  int GetDPBits();
+  // Expected jumps : 2*sqrt(w) plus the DP overhead of the herds
+  double GetExpectedOps();
+  DPTable *GetTable();
+
+  // Work file, header with range, target and DP bits, then the DP table
+  bool Save(std::string fileName);
+  bool Merge(std::string fileName, FoundCallback found, uint64_t *nbLoaded);
+
+  // Worker loop, returns only when the key is found
+  void Search(int thread, Reporter *reporter, FoundCallback found);
+
+private:
+
+  void RandomDist(Int *dist, std::mt19937_64 &rng);
+  void Spawn(int herd, Int *dist, Point &P, std::mt19937_64 &rng, FoundCallback &found);
+  void Collide(Int *tameDist, Int *wildDist, FoundCallback &found);
+  bool CheckKey(Int &key, FoundCallback &found);
+  std::string GetHeader();
+
+  Secp256K1 *secp;
+  Point target;        // Q
+  Point wildStart;     // Q' = Q - aG
+  int rangeBits;
+  Int rangeStart;
+  Int rangeWidth;
+  int nbThread;
+
+  Point jumpPoint[KANGAROO_NB_JUMP];
+  Int jumpDist[KANGAROO_NB_JUMP];
+
+  int dpBits;
+  uint64_t dpMask;     // On x.bits64[3]
+  DPTable table;
+  std::atomic<bool> tableFull;  // DPs dropped, warned once
+
+};
+
+#endif // KANGAROOH
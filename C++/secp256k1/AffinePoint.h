@@ -0,0 +1,106 @@
+#ifndef AFFINEPOINTH
+#define AFFINEPOINTH
+
+#include "Point.h"
+#include "FieldElement.h"
+
+// Affine point of the precomputed tables and batch buffers : x and y in 4
+// limbs of 64 bits, one cache line per point where Point takes three
+// 40-byte Int. z is 1, the values are the ones given to Set.
+class alignas(64) AffinePoint {
+
+public:
+
+  // p must be affine (z = 1) with x and y below 2^256
+  void Set(Point *p);
+  void Set(Int *x, Int *y);
+  // Canonical values of x and y
+  void Set(FieldElement *x, FieldElement *y);
+
+  void Get(Point *p);
+  void GetX(Int *r);
+  void GetY(Int *r);
+
+  bool IsYEven();
+  // Big endian bytes of x and y, 32 each
+  void GetXBytes(unsigned char *b);
+  void GetYBytes(unsigned char *b);
+
+  uint64_t x[4];
+  uint64_t y[4];
+
+};
+
+static inline void ap_set(uint64_t *r, Int *a) {
+  r[0] = a->bits64[0];
+  r[1] = a->bits64[1];
+  r[2] = a->bits64[2];
+  r[3] = a->bits64[3];
+}
+
+static inline void ap_get(Int *r, uint64_t *a) {
+  r->bits64[0] = a[0];
+  r->bits64[1] = a[1];
+  r->bits64[2] = a[2];
+  r->bits64[3] = a[3];
+  for (int i = 4; i < NB64BLOCK; i++)
+    r->bits64[i] = 0;
+}
+
+static inline void ap_bytes(unsigned char *b, uint64_t *a) {
+  uint64_t *ptr = (uint64_t *)b;
+  ptr[3] = _byteswap_uint64(a[0]);
+  ptr[2] = _byteswap_uint64(a[1]);
+  ptr[1] = _byteswap_uint64(a[2]);
+  ptr[0] = _byteswap_uint64(a[3]);
+}
+
+inline void AffinePoint::Set(Point *p) {
+  ap_set(x, &p->x);
+  ap_set(y, &p->y);
+}
+
+inline void AffinePoint::Set(Int *x, Int *y) {
+  ap_set(this->x, x);
+  ap_set(this->y, y);
+}
+
+inline void AffinePoint::Set(FieldElement *x, FieldElement *y) {
+  FieldElement t;
+  t.Set(x);
+  t.Normalize();
+  for (int i = 0; i < 4; i++)
+    this->x[i] = t.n[i];
+  t.Set(y);
+  t.Normalize();
+  for (int i = 0; i < 4; i++)
+    this->y[i] = t.n[i];
+}
+
+inline void AffinePoint::Get(Point *p) {
+  ap_get(&p->x, x);
+  ap_get(&p->y, y);
+  p->z.SetInt32(1);
+}
+
+inline void AffinePoint::GetX(Int *r) {
+  ap_get(r, x);
+}
+
+inline void AffinePoint::GetY(Int *r) {
+  ap_get(r, y);
+}
+
+inline bool AffinePoint::IsYEven() {
+  return (y[0] & 1) == 0;
+}
+
+inline void AffinePoint::GetXBytes(unsigned char *b) {
+  ap_bytes(b, x);
+}
+
+inline void AffinePoint::GetYBytes(unsigned char *b) {
+  ap_bytes(b, y);
+}
+
+#endif // AFFINEPOINTH
@@ -0,0 +1,263 @@
+#include "FieldBatch.h"
+#include "../util/Cpu.h"
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <atomic>
+
+#define M52 0xFFFFFFFFFFFFFULL
+
+FieldBatch::FieldBatch(int size) {
+  this->size = (size + FB_MAX_LANES - 1) / FB_MAX_LANES * FB_MAX_LANES;
+  data = (uint64_t *)aligned_alloc(64, FB_LIMBS * this->size * sizeof(uint64_t));
+  memset(data, 0, FB_LIMBS * this->size * sizeof(uint64_t));
+  for (int j = 0; j < FB_LIMBS; j++)
+    n[j] = data + j * this->size;
+}
+
+FieldBatch::~FieldBatch() {
+  free(data);
+}
+
+void FieldBatch::Set(int i, FieldElement *a) {
+  n[0][i] = a->n[0] & M52;
+  n[1][i] = ((a->n[0] >> 52) | (a->n[1] << 12)) & M52;
+  n[2][i] = ((a->n[1] >> 40) | (a->n[2] << 24)) & M52;
+  n[3][i] = ((a->n[2] >> 28) | (a->n[3] << 36)) & M52;
+  n[4][i] = a->n[3] >> 16;
+}
+
+void FieldBatch::Set(int i, Int *a) {
+  FieldElement e;
+  e.Set(a);
+  Set(i, &e);
+}
+
+void FieldBatch::Get(int i, FieldElement *r) {
+  r->n[0] = n[0][i] | (n[1][i] << 52);
+  r->n[1] = (n[1][i] >> 12) | (n[2][i] << 40);
+  r->n[2] = (n[2][i] >> 24) | (n[3][i] << 28);
+  r->n[3] = (n[3][i] >> 36) | (n[4][i] << 16);
+}
+
+void FieldBatch::Get(int i, Int *r) {
+  FieldElement e;
+  Get(i, &e);
+  e.Get(r);
+}
+
+void FieldBatch::ModInv(int i, int nb) {
+
+  if (nb <= 0)
+    return;
+
+  // Longer runs go through FieldGroup on a copy
+  if (nb > FB_MAX_LANES) {
+    std::vector<FieldElement> v(nb);
+    for (int k = 0; k < nb; k++)
+      Get(i + k, &v[k]);
+    FieldGroup group(nb);
+    group.Set(v.data());
+    group.ModInv();
+    for (int k = 0; k < nb; k++)
+      Set(i + k, &v[k]);
+    return;
+  }
+
+  FieldElement e[FB_MAX_LANES], p[FB_MAX_LANES], inverse, t;
+
+  for (int k = 0; k < nb; k++)
+    Get(i + k, &e[k]);
+  p[0].Set(&e[0]);
+  for (int k = 1; k < nb; k++)
+    p[k].Mul(&p[k - 1], &e[k]);
+
+  inverse.Set(&p[nb - 1]);
+  inverse.Inv();
+
+  for (int k = nb - 1; k > 0; k--) {
+    t.Mul(&p[k - 1], &inverse);
+    inverse.Mul(&e[k]);
+    Set(i + k, &t);
+  }
+  Set(i, &inverse);
+
+}
+
+static void ScalarMul(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb) {
+  FieldElement x, y;
+  for (int i = 0; i < nb; i++) {
+    a->Get(i, &x);
+    b->Get(i, &y);
+    x.Mul(&y);
+    r->Set(i, &x);
+  }
+}
+
+static void ScalarSqr(FieldBatch *r, FieldBatch *a, int nb) {
+  FieldElement x;
+  for (int i = 0; i < nb; i++) {
+    a->Get(i, &x);
+    x.Sqr(&x);
+    r->Set(i, &x);
+  }
+}
+
+static void ScalarSub(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb) {
+  FieldElement x, y;
+  for (int i = 0; i < nb; i++) {
+    a->Get(i, &x);
+    b->Get(i, &y);
+    x.Sub(&x, &y);
+    r->Set(i, &x);
+  }
+}
+
+// Same formulas as the SIMD kernels on FieldElement and FieldGroup,
+// dx and pre are not used
+static void ScalarAddPoints(FieldElement *x, FieldElement *y, FieldBatch *ax, FieldBatch *ay, int nb,
+                            FieldBatch *dx, FieldBatch *pre,
+                            FieldBatch *px, FieldBatch *py, FieldBatch *mx, FieldBatch *my) {
+
+  std::vector<FieldElement> inv(nb);
+  FieldGroup modGroup(nb);
+  FieldElement a, b, s, rx, ry;
+
+  for (int i = 0; i < nb; i++) {
+    ax->Get(i, &a);
+    inv[i].Sub(x, &a);
+  }
+  modGroup.Set(inv.data());
+  modGroup.ModInv();
+
+  for (int i = 0; i < nb; i++) {
+
+    ax->Get(i, &a);
+    ay->Get(i, &b);
+
+    s.Sub(y, &b);
+    s.Mul(&inv[i]);
+    rx.Sqr(&s);
+    rx.Sub(&rx, x);
+    rx.Sub(&rx, &a);
+    ry.Sub(x, &rx);
+    ry.Mul(&s, &ry);
+    ry.Sub(&ry, y);
+    px->Set(i, &rx);
+    py->Set(i, &ry);
+
+    s.Add(y, &b);
+    s.Mul(&inv[i]);
+    rx.Sqr(&s);
+    rx.Sub(&rx, x);
+    rx.Sub(&rx, &a);
+    ry.Sub(x, &rx);
+    ry.Mul(&s, &ry);
+    ry.Sub(&ry, y);
+    mx->Set(i, &rx);
+    my->Set(i, &ry);
+
+  }
+
+}
+
+const FieldBatchKernels field_batch_scalar = {
+  "scalar",
+  1,
+  ScalarMul,
+  ScalarSqr,
+  ScalarSub,
+  ScalarAddPoints
+};
+
+static const FieldBatchKernels *allKernels[] = {
+  &field_batch_scalar,
+  &field_batch_avx2,
+  &field_batch_avx512,
+  &field_batch_ifma
+};
+
+static bool supported(const FieldBatchKernels *k) {
+  const CpuFeatures &cpu = cpu_features();
+  if (k == &field_batch_avx2)
+    return cpu.avx2;
+  if (k == &field_batch_avx512)
+    return cpu.avx512f;
+  if (k == &field_batch_ifma)
+    return cpu.avx512ifma;
+  return true;
+}
+
+// Time a batch of point additions, any field values do
+static double time_kernels(const FieldBatchKernels *k) {
+
+  const int n = 256;
+  FieldBatch ax(n), ay(n), dx(n), pre(n), px(n), py(n), mx(n), my(n);
+  FieldElement x, y, e;
+
+  for (int j = 0; j < 4; j++) {
+    x.n[j] = 0x9E3779B97F4A7C15ULL * (j + 1);
+    y.n[j] = 0xC2B2AE3D27D4EB4FULL * (j + 1);
+  }
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < 4; j++)
+      e.n[j] = 0xFF51AFD7ED558CCDULL * (4 * i + j + 1);
+    ax.Set(i, &e);
+    e.Sqr(&e);
+    ay.Set(i, &e);
+  }
+
+  k->AddPoints(&x, &y, &ax, &ay, n, &dx, &pre, &px, &py, &mx, &my);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < 8; r++)
+    k->AddPoints(&x, &y, &ax, &ay, n, &dx, &pre, &px, &py, &mx, &my);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+}
+
+static const FieldBatchKernels *best_kernels() {
+
+  const FieldBatchKernels *best = &field_batch_scalar;
+  double tBest = time_kernels(best);
+  for (const FieldBatchKernels *k : allKernels) {
+    if (k == best || !supported(k))
+      continue;
+    double t = time_kernels(k);
+    if (t < tBest) {
+      best = k;
+      tBest = t;
+    }
+  }
+  return best;
+
+}
+
+// NULL until resolved, read and set from any thread
+static std::atomic<const FieldBatchKernels *> batchKernels(NULL);
+
+const FieldBatchKernels *field_batch_kernels() {
+  const FieldBatchKernels *k = batchKernels;
+  if (k == NULL) {
+    static const FieldBatchKernels *best = best_kernels();
+    // Kernels set meanwhile by field_batch_set_kernels are kept
+    if (batchKernels.compare_exchange_strong(k, best))
+      k = best;
+  }
+  return k;
+}
+
+const FieldBatchKernels *field_batch_kernels(std::string name) {
+  for (const FieldBatchKernels *k : allKernels)
+    if (name == k->name)
+      return supported(k) ? k : NULL;
+  return NULL;
+}
+
+bool field_batch_set_kernels(std::string name) {
+  const FieldBatchKernels *k = field_batch_kernels(name);
+  if (k == NULL)
+    return false;
+  batchKernels = k;
+  return true;
+}
@@ -0,0 +1,73 @@
+#ifndef FIELDBATCHH
+#define FIELDBATCHH
+
+#include <string>
+#include "FieldElement.h"
+
+#define FB_LIMBS 5
+#define FB_MAX_LANES 8
+
+// Field elements of a batch in structure of arrays, 5 limbs of 52 bits :
+// limb j of element i is n[j][i], so one SIMD load gets the same limb of
+// consecutive elements. Limbs 0..3 are below 2^52 and limb 4 below 2^48
+// (value below 2^256), the kernels take and keep that form.
+class FieldBatch {
+
+public:
+
+  // size is rounded up to a multiple of FB_MAX_LANES
+  FieldBatch(int size);
+  ~FieldBatch();
+
+  void Set(int i, FieldElement *a);
+  void Set(int i, Int *a);
+  void Get(int i, FieldElement *r);
+  void Get(int i, Int *r);
+
+  // Elements i to i+nb-1 inverted in place, with one Inv. Up to
+  // FB_MAX_LANES on the stack, more through FieldGroup, none when nb <= 0.
+  void ModInv(int i, int nb);
+
+  int size;
+  uint64_t *n[FB_LIMBS];
+
+private:
+
+  uint64_t *data;
+
+};
+
+// Kernels of one SIMD width on rows of FieldBatch, nb elements from 0.
+// The scalar ones run FieldElement on each element.
+struct FieldBatchKernels {
+
+  const char *name;
+  int lanes;
+
+  void (*Mul)(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb);
+  void (*Sqr)(FieldBatch *r, FieldBatch *a, int nb);
+  void (*Sub)(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb);
+
+  // (x,y) + (ax,ay)[i] into (px,py)[i] and (x,y) - (ax,ay)[i] into
+  // (mx,my)[i] for i < nb, with one batch inversion of the x - ax[i] in dx
+  // (pre is scratch). No ax[i] may equal x.
+  void (*AddPoints)(FieldElement *x, FieldElement *y, FieldBatch *ax, FieldBatch *ay, int nb,
+                    FieldBatch *dx, FieldBatch *pre,
+                    FieldBatch *px, FieldBatch *py, FieldBatch *mx, FieldBatch *my);
+
+};
+
+extern const FieldBatchKernels field_batch_scalar;
+extern const FieldBatchKernels field_batch_avx2;
+extern const FieldBatchKernels field_batch_avx512;
+extern const FieldBatchKernels field_batch_ifma;
+
+// Fastest kernels on this CPU, timed once on a batch of point additions
+const FieldBatchKernels *field_batch_kernels();
+
+// Kernels by name (scalar, avx2, avx512 or ifma), NULL when unknown or not
+// supported by this CPU. A name selects them for field_batch_kernels().
+const FieldBatchKernels *field_batch_kernels(std::string name);
+bool field_batch_set_kernels(std::string name);
+
+#endif // FIELDBATCHH
@@ -0,0 +1,6 @@
+// 4-lane field arithmetic, see FieldBatch_simd.h
+#define FB_LANES 4
+#define FB_MUL32(a, b) ((vu64)_mm256_mul_epu32((__m256i)(a), (__m256i)(b)))
+#define FB_KERNELS field_batch_avx2
+#define FB_KERNELS_NAME "avx2"
+#include "FieldBatch_simd.h"
@@ -0,0 +1,6 @@
+// 8-lane field arithmetic, see FieldBatch_simd.h
+#define FB_LANES 8
+#define FB_MUL32(a, b) ((vu64)_mm512_mul_epu32((__m512i)(a), (__m512i)(b)))
+#define FB_KERNELS field_batch_avx512
+#define FB_KERNELS_NAME "avx512"
+#include "FieldBatch_simd.h"
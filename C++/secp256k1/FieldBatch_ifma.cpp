@@ -0,0 +1,8 @@
+// 8-lane field arithmetic on 52-bit multiply-add (AVX-512 IFMA), see FieldBatch_simd.h
+#define FB_LANES 8
+#define FB_MUL32(a, b) ((vu64)_mm512_mul_epu32((__m512i)(a), (__m512i)(b)))
+#define FB_MADD52LO(c, a, b) ((vu64)_mm512_madd52lo_epu64((__m512i)(c), (__m512i)(a), (__m512i)(b)))
+#define FB_MADD52HI(c, a, b) ((vu64)_mm512_madd52hi_epu64((__m512i)(c), (__m512i)(a), (__m512i)(b)))
+#define FB_KERNELS field_batch_ifma
+#define FB_KERNELS_NAME "ifma"
+#include "FieldBatch_simd.h"
@@ -0,0 +1,377 @@
+// Field arithmetic on FB_LANES elements of a FieldBatch at once, see FieldBatch.h.
+// Included by FieldBatch_avx2.cpp, FieldBatch_avx512.cpp and FieldBatch_ifma.cpp,
+// each one is compiled with the matching -m flags and defines FB_LANES, FB_MUL32
+// (32x32 bits product of each lane), FB_KERNELS and FB_KERNELS_NAME.
+// With FB_MADD52LO and FB_MADD52HI (IFMA) the 52-bit limbs are multiplied as they
+// are, without them they are split in 26-bit halves for FB_MUL32.
+
+#include <immintrin.h>
+#include "FieldBatch.h"
+
+namespace {
+
+typedef uint64_t vu64 __attribute__((vector_size(8 * FB_LANES)));
+
+#define M52 0xFFFFFFFFFFFFFULL
+#define M48 0xFFFFFFFFFFFFULL
+#define M26 0x3FFFFFFULL
+
+// 2^260 mod P = 16*K
+#define R52 0x1000003D10ULL
+
+inline vu64 Splat(uint64_t v) {
+  return (vu64){} + v;
+}
+
+inline void Load(vu64 *r, FieldBatch *a, int i) {
+  for (int j = 0; j < FB_LIMBS; j++)
+    r[j] = *(vu64 *)(a->n[j] + i);
+}
+
+inline void Store(FieldBatch *r, int i, vu64 *a) {
+  for (int j = 0; j < FB_LIMBS; j++)
+    *(vu64 *)(r->n[j] + i) = a[j];
+}
+
+// Same element in all the lanes
+inline void Splat(vu64 *r, FieldElement *a) {
+  r[0] = Splat(a->n[0] & M52);
+  r[1] = Splat(((a->n[0] >> 52) | (a->n[1] << 12)) & M52);
+  r[2] = Splat(((a->n[1] >> 40) | (a->n[2] << 24)) & M52);
+  r[3] = Splat(((a->n[2] >> 28) | (a->n[3] << 36)) & M52);
+  r[4] = Splat(a->n[3] >> 16);
+}
+
+// Back to limbs of 52 bits and a limb 4 of 48 bits, the carry out of 2^256
+// comes back as K. The second pass carries at most one bit, a carry out of
+// limb 4 there leaves limbs 1 to 3 at 0 and room for K in limb 0.
+inline void Carry(vu64 *t) {
+
+  vu64 c;
+
+  for (int pass = 0; pass < 2; pass++) {
+    c = t[0] >> 52; t[0] &= M52; t[1] += c;
+    c = t[1] >> 52; t[1] &= M52; t[2] += c;
+    c = t[2] >> 52; t[2] &= M52; t[3] += c;
+    c = t[3] >> 52; t[3] &= M52; t[4] += c;
+    c = t[4] >> 48; t[4] &= M48;
+    t[0] += (c << 32) + FB_MUL32(c, Splat(0x3D1));
+  }
+
+}
+
+inline void Add(vu64 *r, vu64 *a, vu64 *b) {
+  for (int j = 0; j < FB_LIMBS; j++)
+    r[j] = a[j] + b[j];
+  Carry(r);
+}
+
+// r = a + 2P - b, each limb of 2P is above the one of b
+inline void Sub(vu64 *r, vu64 *a, vu64 *b) {
+  r[0] = a[0] + 0x1FFFFDFFFFF85EULL - b[0];
+  r[1] = a[1] + 0x1FFFFFFFFFFFFEULL - b[1];
+  r[2] = a[2] + 0x1FFFFFFFFFFFFEULL - b[2];
+  r[3] = a[3] + 0x1FFFFFFFFFFFFEULL - b[3];
+  r[4] = a[4] + 0x1FFFFFFFFFFFEULL - b[4];
+  Carry(r);
+}
+
+#ifdef FB_MADD52LO
+
+// Column k of the product gets the low halves of a[i]*b[j], i+j = k, and
+// the high ones of i+j = k-1, 10 values below 2^52 at most
+#define FB_MULADD(k, x, y) {                    \
+  t[k] = FB_MADD52LO(t[k], x, y);               \
+  t[k + 1] = FB_MADD52HI(t[k + 1], x, y);       \
+}
+
+// t[0..9] columns below 2^56 to r
+inline void Reduce(vu64 *r, vu64 *t) {
+
+  vu64 c, u, R = Splat(R52);
+
+  for (int k = 0; k < 9; k++) {
+    c = t[k] >> 52; t[k] &= M52; t[k + 1] += c;
+  }
+  c = t[9] >> 52; t[9] &= M52;
+
+  // Columns 5 to 9 are at 2^260 and above, c at 2^520 comes down to
+  // column 5 as R, so does u
+  r[0] = FB_MADD52LO(t[0], t[5], R);
+  r[1] = FB_MADD52HI(t[1], t[5], R);
+  r[1] = FB_MADD52LO(r[1], t[6], R);
+  r[2] = FB_MADD52HI(t[2], t[6], R);
+  r[2] = FB_MADD52LO(r[2], t[7], R);
+  r[3] = FB_MADD52HI(t[3], t[7], R);
+  r[3] = FB_MADD52LO(r[3], t[8], R);
+  r[4] = FB_MADD52HI(t[4], t[8], R);
+  r[4] = FB_MADD52LO(r[4], t[9], R);
+  u = FB_MADD52HI(Splat(0), t[9], R);
+  u = FB_MADD52LO(u, c, R);
+  r[0] = FB_MADD52LO(r[0], u, R);
+  r[1] = FB_MADD52HI(r[1], u, R);
+
+  Carry(r);
+
+}
+
+inline void Mul(vu64 *r, vu64 *a, vu64 *b) {
+
+  vu64 t[10] = {};
+
+  FB_MULADD(0, a[0], b[0]);
+  FB_MULADD(1, a[0], b[1]);
+  FB_MULADD(1, a[1], b[0]);
+  FB_MULADD(2, a[0], b[2]);
+  FB_MULADD(2, a[1], b[1]);
+  FB_MULADD(2, a[2], b[0]);
+  FB_MULADD(3, a[0], b[3]);
+  FB_MULADD(3, a[1], b[2]);
+  FB_MULADD(3, a[2], b[1]);
+  FB_MULADD(3, a[3], b[0]);
+  FB_MULADD(4, a[0], b[4]);
+  FB_MULADD(4, a[1], b[3]);
+  FB_MULADD(4, a[2], b[2]);
+  FB_MULADD(4, a[3], b[1]);
+  FB_MULADD(4, a[4], b[0]);
+  FB_MULADD(5, a[1], b[4]);
+  FB_MULADD(5, a[2], b[3]);
+  FB_MULADD(5, a[3], b[2]);
+  FB_MULADD(5, a[4], b[1]);
+  FB_MULADD(6, a[2], b[4]);
+  FB_MULADD(6, a[3], b[3]);
+  FB_MULADD(6, a[4], b[2]);
+  FB_MULADD(7, a[3], b[4]);
+  FB_MULADD(7, a[4], b[3]);
+  FB_MULADD(8, a[4], b[4]);
+
+  Reduce(r, t);
+
+}
+
+// Cross products once then doubled, plus the squares of the limbs
+inline void Sqr(vu64 *r, vu64 *a) {
+
+  vu64 t[10] = {};
+
+  FB_MULADD(1, a[0], a[1]);
+  FB_MULADD(2, a[0], a[2]);
+  FB_MULADD(3, a[0], a[3]);
+  FB_MULADD(3, a[1], a[2]);
+  FB_MULADD(4, a[0], a[4]);
+  FB_MULADD(4, a[1], a[3]);
+  FB_MULADD(5, a[1], a[4]);
+  FB_MULADD(5, a[2], a[3]);
+  FB_MULADD(6, a[2], a[4]);
+  FB_MULADD(7, a[3], a[4]);
+  for (int k = 1; k < 9; k++)
+    t[k] += t[k];
+  FB_MULADD(0, a[0], a[0]);
+  FB_MULADD(2, a[1], a[1]);
+  FB_MULADD(4, a[2], a[2]);
+  FB_MULADD(6, a[3], a[3]);
+  FB_MULADD(8, a[4], a[4]);
+
+  Reduce(r, t);
+
+}
+
+#else
+
+// 10 limbs of 26 bits, limb 9 below 2^22
+inline void Split(vu64 *h, vu64 *a) {
+  for (int j = 0; j < FB_LIMBS; j++) {
+    h[2 * j] = a[j] & M26;
+    h[2 * j + 1] = a[j] >> 26;
+  }
+}
+
+// t[0..18] columns of 26 bits below 2^56 to r
+inline void Reduce(vu64 *r, vu64 *t) {
+
+  vu64 c;
+
+  for (int k = 0; k < 19; k++) {
+    c = t[k] >> 26; t[k] &= M26; t[k + 1] += c;
+  }
+
+  // Column k >= 10 is at 2^260 above column k-10 : R = 2^36 + 0x3D10.
+  // From the top, column 10 also gets the carry column 19 (below 2^18).
+  for (int k = 19; k >= 10; k--) {
+    t[k - 10] += FB_MUL32(t[k], Splat(0x3D10));
+    t[k - 9] += t[k] << 10;
+  }
+
+  for (int k = 0; k < 9; k++) {
+    c = t[k] >> 26; t[k] &= M26; t[k + 1] += c;
+  }
+  c = t[9] >> 26; t[9] &= M26;
+
+  for (int j = 0; j < FB_LIMBS; j++)
+    r[j] = t[2 * j] | (t[2 * j + 1] << 26);
+  r[0] += (c << 36) + FB_MUL32(c, Splat(0x3D10));
+
+  Carry(r);
+
+}
+
+inline void Mul(vu64 *r, vu64 *a, vu64 *b) {
+
+  vu64 ha[10], hb[10], t[20] = {};
+
+  Split(ha, a);
+  Split(hb, b);
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; i++)
+#pragma GCC unroll 10
+    for (int j = 0; j < 10; j++)
+      t[i + j] += FB_MUL32(ha[i], hb[j]);
+
+  Reduce(r, t);
+
+}
+
+inline void Sqr(vu64 *r, vu64 *a) {
+
+  vu64 h[10], h2[10], t[20] = {};
+
+  Split(h, a);
+  for (int i = 0; i < 10; i++)
+    h2[i] = h[i] + h[i];
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; i++) {
+    t[2 * i] += FB_MUL32(h[i], h[i]);
+#pragma GCC unroll 9
+    for (int j = i + 1; j < 10; j++)
+      t[i + j] += FB_MUL32(h2[i], h[j]);
+  }
+
+  Reduce(r, t);
+
+}
+
+#endif
+
+#define FB_NAME(k, op) k##_##op
+#define FB_FUNC(k, op) FB_NAME(k, op)
+
+void FB_FUNC(FB_KERNELS, Mul)(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb) {
+  vu64 x[FB_LIMBS], y[FB_LIMBS];
+  for (int i = 0; i < nb; i += FB_LANES) {
+    Load(x, a, i);
+    Load(y, b, i);
+    Mul(x, x, y);
+    Store(r, i, x);
+  }
+}
+
+void FB_FUNC(FB_KERNELS, Sqr)(FieldBatch *r, FieldBatch *a, int nb) {
+  vu64 x[FB_LIMBS];
+  for (int i = 0; i < nb; i += FB_LANES) {
+    Load(x, a, i);
+    Sqr(x, x);
+    Store(r, i, x);
+  }
+}
+
+void FB_FUNC(FB_KERNELS, Sub)(FieldBatch *r, FieldBatch *a, FieldBatch *b, int nb) {
+  vu64 x[FB_LIMBS], y[FB_LIMBS];
+  for (int i = 0; i < nb; i += FB_LANES) {
+    Load(x, a, i);
+    Load(y, b, i);
+    Sub(x, x, y);
+    Store(r, i, x);
+  }
+}
+
+// One prefix product chain per lane : element i is in chain i % FB_LANES, the
+// FB_LANES chain products are inverted together by FieldBatch::ModInv
+void FB_FUNC(FB_KERNELS, AddPoints)(FieldElement *x, FieldElement *y, FieldBatch *ax, FieldBatch *ay, int nb,
+                                   FieldBatch *dx, FieldBatch *pre,
+                                   FieldBatch *px, FieldBatch *py, FieldBatch *mx, FieldBatch *my) {
+
+  vu64 X[FB_LIMBS], Y[FB_LIMBS], a[FB_LIMBS], b[FB_LIMBS];
+  vu64 inv[FB_LIMBS], s[FB_LIMBS], rx[FB_LIMBS], ry[FB_LIMBS];
+  int last = (nb - 1) / FB_LANES * FB_LANES;
+
+  Splat(X, x);
+  Splat(Y, y);
+
+  // dx = x - ax, the lanes past nb at 1
+  for (int i = 0; i <= last; i += FB_LANES) {
+    Load(a, ax, i);
+    Sub(a, X, a);
+    Store(dx, i, a);
+  }
+  for (int i = nb; i < last + FB_LANES; i++) {
+    dx->n[0][i] = 1;
+    for (int j = 1; j < FB_LIMBS; j++)
+      dx->n[j][i] = 0;
+  }
+
+  Load(s, dx, 0);
+  Store(pre, 0, s);
+  for (int i = FB_LANES; i <= last; i += FB_LANES) {
+    Load(a, dx, i);
+    Mul(s, s, a);
+    Store(pre, i, s);
+  }
+
+  pre->ModInv(last, FB_LANES);
+  Load(inv, pre, last);
+
+  for (int i = last; i > 0; i -= FB_LANES) {
+    Load(a, pre, i - FB_LANES);
+    Mul(s, inv, a);
+    Load(a, dx, i);
+    Mul(inv, inv, a);
+    Store(dx, i, s);
+  }
+  Store(dx, 0, inv);
+
+  for (int i = 0; i <= last; i += FB_LANES) {
+
+    Load(a, ax, i);
+    Load(b, ay, i);
+    Load(inv, dx, i);
+
+    // (x,y) + (ax,ay)
+    Sub(s, Y, b);
+    Mul(s, s, inv);
+    Sqr(rx, s);
+    Sub(rx, rx, X);
+    Sub(rx, rx, a);
+    Sub(ry, X, rx);
+    Mul(ry, s, ry);
+    Sub(ry, ry, Y);
+    Store(px, i, rx);
+    Store(py, i, ry);
+
+    // (x,y) - (ax,ay), same inverse
+    Add(s, Y, b);
+    Mul(s, s, inv);
+    Sqr(rx, s);
+    Sub(rx, rx, X);
+    Sub(rx, rx, a);
+    Sub(ry, X, rx);
+    Mul(ry, s, ry);
+    Sub(ry, ry, Y);
+    Store(mx, i, rx);
+    Store(my, i, ry);
+
+  }
+
+}
+
+} // namespace
+
+extern const FieldBatchKernels FB_KERNELS;
+
+const FieldBatchKernels FB_KERNELS = {
+  FB_KERNELS_NAME,
+  FB_LANES,
+  FB_FUNC(FB_KERNELS, Mul),
+  FB_FUNC(FB_KERNELS, Sqr),
+  FB_FUNC(FB_KERNELS, Sub),
+  FB_FUNC(FB_KERNELS, AddPoints)
+};
@@ -0,0 +1,109 @@
+#include "FieldElement.h"
+#include <stdlib.h>
+
+void FieldElement::Set(Int *a) {
+  n[0] = a->bits64[0];
+  n[1] = a->bits64[1];
+  n[2] = a->bits64[2];
+  n[3] = a->bits64[3];
+}
+
+void FieldElement::Get(Int *r) {
+  FieldElement t;
+  t.Set(this);
+  t.Normalize();
+  r->bits64[0] = t.n[0];
+  r->bits64[1] = t.n[1];
+  r->bits64[2] = t.n[2];
+  r->bits64[3] = t.n[3];
+  r->bits64[4] = 0;
+}
+
+void FieldElement::Set(FieldElement *a) {
+  n[0] = a->n[0];
+  n[1] = a->n[1];
+  n[2] = a->n[2];
+  n[3] = a->n[3];
+}
+
+void FieldElement::SetInt32(uint32_t value) {
+  n[0] = value;
+  n[1] = 0;
+  n[2] = 0;
+  n[3] = 0;
+}
+
+// A value of [P,2^256) is below 2P, it loses P once : + K mod 2^256
+void FieldElement::Normalize() {
+
+  unsigned char c;
+  uint64_t r0, r1, r2, r3;
+
+  c = _addcarry_u64(0, n[0], FE_K, &r0);
+  c = _addcarry_u64(c, n[1], 0, &r1);
+  c = _addcarry_u64(c, n[2], 0, &r2);
+  c = _addcarry_u64(c, n[3], 0, &r3);
+  if (c) {
+    n[0] = r0;
+    n[1] = r1;
+    n[2] = r2;
+    n[3] = r3;
+  }
+
+}
+
+bool FieldElement::IsZero() {
+  FieldElement t;
+  t.Set(this);
+  t.Normalize();
+  return (t.n[0] | t.n[1] | t.n[2] | t.n[3]) == 0;
+}
+
+bool FieldElement::IsEqual(FieldElement *a) {
+  FieldElement t;
+  t.Sub(this, a);
+  return t.IsZero();
+}
+
+void FieldElement::Inv() {
+  Int i;
+  Get(&i);
+  i.ModInv();
+  Set(&i);
+}
+
+FieldGroup::FieldGroup(int size) {
+  this->size = size;
+  subp = (FieldElement *)malloc(size * sizeof(FieldElement));
+}
+
+FieldGroup::~FieldGroup() {
+  free(subp);
+}
+
+void FieldGroup::Set(FieldElement *elems) {
+  this->elems = elems;
+}
+
+// Inversion of the whole group with one Inv
+void FieldGroup::ModInv() {
+
+  FieldElement newValue;
+  FieldElement inverse;
+
+  subp[0].Set(&elems[0]);
+  for (int i = 1; i < size; i++)
+    subp[i].Mul(&subp[i - 1], &elems[i]);
+
+  inverse.Set(&subp[size - 1]);
+  inverse.Inv();
+
+  for (int i = size - 1; i > 0; i--) {
+    newValue.Mul(&subp[i - 1], &inverse);
+    inverse.Mul(&elems[i]);
+    elems[i].Set(&newValue);
+  }
+
+  elems[0].Set(&inverse);
+
+}
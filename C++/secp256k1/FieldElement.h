@@ -0,0 +1,266 @@
+#ifndef FIELDELEMENTH
+#define FIELDELEMENTH
+
+#include "Int.h"
+
+// 2^256 mod P
+#define FE_K 0x1000003D1ULL
+
+// Element of the secp256k1 field in 4 limbs of 64 bits.
+// Values are weakly reduced : any 256-bit number, equal to the element mod P.
+// Add, Sub, Mul and Sqr take and return weakly reduced values, only Get,
+// IsZero and IsEqual need the canonical one. The arithmetic is inline for
+// the point formulas of the batch loops, Int is the bridge for the rest.
+class FieldElement {
+
+public:
+
+  // Int bridge, the Int must be in [0,2^256)
+  void Set(Int *a);
+  void Get(Int *r);
+
+  void Set(FieldElement *a);
+  void SetInt32(uint32_t value);
+
+  void Add(FieldElement *a, FieldElement *b);
+  void Sub(FieldElement *a, FieldElement *b);
+  void Neg(FieldElement *a);
+  void Mul(FieldElement *a, FieldElement *b);
+  void Mul(FieldElement *a);
+  void Sqr(FieldElement *a);
+
+  // this <- this^-1, through Int::ModInv
+  void Inv();
+
+  // Canonical value in [0,P)
+  void Normalize();
+  bool IsZero();
+  bool IsEqual(FieldElement *a);
+
+  uint64_t n[4];
+
+};
+
+// Batch inversion of FieldElement, as IntGroup for Int
+class FieldGroup {
+
+public:
+
+  FieldGroup(int size);
+  ~FieldGroup();
+  void Set(FieldElement *elems);
+  void ModInv();
+
+private:
+
+  FieldElement *elems;
+  FieldElement *subp;
+  int size;
+
+};
+
+// r = a + b, the carry out of 2^256 is folded back as K, a second one leaves
+// a value below K that cannot carry again
+inline void FieldElement::Add(FieldElement *a, FieldElement *b) {
+
+  unsigned char c;
+  uint64_t r0, r1, r2, r3, k;
+
+  c = _addcarry_u64(0, a->n[0], b->n[0], &r0);
+  c = _addcarry_u64(c, a->n[1], b->n[1], &r1);
+  c = _addcarry_u64(c, a->n[2], b->n[2], &r2);
+  c = _addcarry_u64(c, a->n[3], b->n[3], &r3);
+
+  k = (0ULL - c) & FE_K;
+  c = _addcarry_u64(0, r0, k, &r0);
+  c = _addcarry_u64(c, r1, 0, &r1);
+  c = _addcarry_u64(c, r2, 0, &r2);
+  c = _addcarry_u64(c, r3, 0, &r3);
+
+  n[0] = r0 + ((0ULL - c) & FE_K);
+  n[1] = r1;
+  n[2] = r2;
+  n[3] = r3;
+
+}
+
+// r = a - b, a borrow of 2^256 is taken back as K
+inline void FieldElement::Sub(FieldElement *a, FieldElement *b) {
+
+  unsigned char c;
+  uint64_t r0, r1, r2, r3, k;
+
+  c = _subborrow_u64(0, a->n[0], b->n[0], &r0);
+  c = _subborrow_u64(c, a->n[1], b->n[1], &r1);
+  c = _subborrow_u64(c, a->n[2], b->n[2], &r2);
+  c = _subborrow_u64(c, a->n[3], b->n[3], &r3);
+
+  k = (0ULL - c) & FE_K;
+  c = _subborrow_u64(0, r0, k, &r0);
+  c = _subborrow_u64(c, r1, 0, &r1);
+  c = _subborrow_u64(c, r2, 0, &r2);
+  c = _subborrow_u64(c, r3, 0, &r3);
+
+  n[0] = r0 - ((0ULL - c) & FE_K);
+  n[1] = r1;
+  n[2] = r2;
+  n[3] = r3;
+
+}
+
+inline void FieldElement::Neg(FieldElement *a) {
+  FieldElement zero;
+  zero.n[0] = zero.n[1] = zero.n[2] = zero.n[3] = 0;
+  Sub(&zero, a);
+}
+
+// r[0..7] = r[0..7] mod P into n, the high half is folded as K*high
+static inline void fe_reduce512(uint64_t *r, uint64_t *n) {
+
+  unsigned char c;
+  uint64_t t[5], h, l;
+
+  // 512 to 289 bits
+  t[0] = _umul128(r[4], FE_K, &h);
+  t[1] = _umul128(r[5], FE_K, &l);
+  c = _addcarry_u64(0, t[1], h, &t[1]);
+  t[2] = _umul128(r[6], FE_K, &h);
+  c = _addcarry_u64(c, t[2], l, &t[2]);
+  t[3] = _umul128(r[7], FE_K, &l);
+  c = _addcarry_u64(c, t[3], h, &t[3]);
+  t[4] = l + c;
+
+  c = _addcarry_u64(0, r[0], t[0], &r[0]);
+  c = _addcarry_u64(c, r[1], t[1], &r[1]);
+  c = _addcarry_u64(c, r[2], t[2], &r[2]);
+  c = _addcarry_u64(c, r[3], t[3], &r[3]);
+
+  // 289 to 256 bits, t[4]+c < 2^34
+  l = _umul128(t[4] + c, FE_K, &h);
+  c = _addcarry_u64(0, r[0], l, &r[0]);
+  c = _addcarry_u64(c, r[1], h, &r[1]);
+  c = _addcarry_u64(c, r[2], 0, &r[2]);
+  c = _addcarry_u64(c, r[3], 0, &r[3]);
+
+  // A last carry leaves r[1..3] at 0
+  c = _addcarry_u64(0, r[0], (0ULL - c) & FE_K, &n[0]);
+  n[1] = r[1] + c;
+  n[2] = r[2];
+  n[3] = r[3];
+
+}
+
+// Column accumulator (c0,c1,c2) += x*y
+#define FE_MULADD(x, y) {                    \
+  l = _umul128(x, y, &h);                    \
+  c = _addcarry_u64(0, c0, l, &c0);          \
+  c = _addcarry_u64(c, c1, h, &c1);          \
+  c2 += c;                                   \
+}
+
+// Next column : r[k] = c0, the accumulator shifts by one limb
+#define FE_COLUMN(k) { r[k] = c0; c0 = c1; c1 = c2; c2 = 0; }
+
+// Product scanning, one column of the 512-bit product at a time
+inline void FieldElement::Mul(FieldElement *a, FieldElement *b) {
+
+  unsigned char c;
+  uint64_t r[8], h, l, c0 = 0, c1 = 0, c2 = 0;
+  uint64_t a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3];
+  uint64_t b0 = b->n[0], b1 = b->n[1], b2 = b->n[2], b3 = b->n[3];
+
+  if (modK1Adx) {
+    modmulk1_adx(n, a->n, b->n);
+    return;
+  }
+
+  FE_MULADD(a0, b0);
+  FE_COLUMN(0);
+  FE_MULADD(a0, b1);
+  FE_MULADD(a1, b0);
+  FE_COLUMN(1);
+  FE_MULADD(a0, b2);
+  FE_MULADD(a1, b1);
+  FE_MULADD(a2, b0);
+  FE_COLUMN(2);
+  FE_MULADD(a0, b3);
+  FE_MULADD(a1, b2);
+  FE_MULADD(a2, b1);
+  FE_MULADD(a3, b0);
+  FE_COLUMN(3);
+  FE_MULADD(a1, b3);
+  FE_MULADD(a2, b2);
+  FE_MULADD(a3, b1);
+  FE_COLUMN(4);
+  FE_MULADD(a2, b3);
+  FE_MULADD(a3, b2);
+  FE_COLUMN(5);
+  FE_MULADD(a3, b3);
+  r[6] = c0;
+  r[7] = c1;
+
+  fe_reduce512(r, n);
+
+}
+
+inline void FieldElement::Mul(FieldElement *a) {
+  Mul(this, a);
+}
+
+// Cross products once then doubled, plus the squares of the limbs
+inline void FieldElement::Sqr(FieldElement *a) {
+
+  unsigned char c;
+  uint64_t r[8], h, l;
+  uint64_t a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3];
+
+  if (modK1Adx) {
+    modsquarek1_adx(n, a->n);
+    return;
+  }
+
+  r[1] = _umul128(a0, a1, &r[2]);
+  l = _umul128(a0, a2, &h);
+  c = _addcarry_u64(0, r[2], l, &r[2]);
+  r[3] = h + c;
+  l = _umul128(a0, a3, &h);
+  c = _addcarry_u64(0, r[3], l, &r[3]);
+  r[4] = h + c;
+  l = _umul128(a1, a2, &h);
+  c = _addcarry_u64(0, r[3], l, &r[3]);
+  c = _addcarry_u64(c, r[4], h, &r[4]);
+  r[5] = c;
+  l = _umul128(a1, a3, &h);
+  c = _addcarry_u64(0, r[4], l, &r[4]);
+  c = _addcarry_u64(c, r[5], h, &r[5]);
+  r[6] = c;
+  l = _umul128(a2, a3, &h);
+  c = _addcarry_u64(0, r[5], l, &r[5]);
+  c = _addcarry_u64(c, r[6], h, &r[6]);
+  r[7] = c;
+
+  r[7] = (r[7] << 1) | (r[6] >> 63);
+  r[6] = (r[6] << 1) | (r[5] >> 63);
+  r[5] = (r[5] << 1) | (r[4] >> 63);
+  r[4] = (r[4] << 1) | (r[3] >> 63);
+  r[3] = (r[3] << 1) | (r[2] >> 63);
+  r[2] = (r[2] << 1) | (r[1] >> 63);
+  r[1] = r[1] << 1;
+
+  r[0] = _umul128(a0, a0, &h);
+  c = _addcarry_u64(0, r[1], h, &r[1]);
+  l = _umul128(a1, a1, &h);
+  c = _addcarry_u64(c, r[2], l, &r[2]);
+  c = _addcarry_u64(c, r[3], h, &r[3]);
+  l = _umul128(a2, a2, &h);
+  c = _addcarry_u64(c, r[4], l, &r[4]);
+  c = _addcarry_u64(c, r[5], h, &r[5]);
+  l = _umul128(a3, a3, &h);
+  c = _addcarry_u64(c, r[6], l, &r[6]);
+  c = _addcarry_u64(c, r[7], h, &r[7]);
+
+  fe_reduce512(r, n);
+
+}
+
+#endif // FIELDELEMENTH
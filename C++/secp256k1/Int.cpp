@@ -890,8 +890,8 @@ void Int::Div(Int *a,Int *mod) {
 
     if (!skipCorrection) {
 
-      // Correct qhat
-      uint64_t nl = (uint64_t)rem.bits[sb-j-1];
+      // Correct qhat, the digit below the last one is 0 (one word divisor)
+      uint64_t nl = (sb-j-1 >= 0) ? (uint64_t)rem.bits[sb-j-1] : 0;
       uint64_t rs = ((uint64_t)qrem << 32) | nl;
       uint64_t estProduct = (uint64_t)_dl * (uint64_t)(qhat);
 
@@ -18,6 +18,14 @@
   #error Unsuported size
 #endif
 
+// ModInv variants
+#define MODINV_XCD        0  // Extended Euclid
+#define MODINV_MONTGOMERY 1  // Montgomery binary inverse
+#define MODINV_PENK       2  // Penk's algorithm
+#define MODINV_DRS62      3  // Variable time divsteps in blocks of 62 (default)
+#define MODINV_SAFEGCD62  4  // Bernstein-Yang safegcd, constant 12 blocks of 62
+#define MODINV_NB         5
+
 class Int {
 
 public:
@@ -94,6 +102,13 @@ public:
   static Int *GetR4();                           // Return R4
   static Int* GetFieldCharacteristic();          // Return field characteristic
 
+  // ModInv variant, MODINV_xxx
+  static void SetModInv(int method);
+  static int GetModInv();
+  static const char *GetModInvName(int method);
+  static int GetModInvMethod(std::string name);  // -1 if unknown
+  static int SelectModInv();                     // Fastest on this CPU, selected
+
   void GCD(Int *a);                          // this <- GCD(this,a)
   void Mod(Int *n);                          // this <- this (mod n)
   void ModInv();                             // this <- this^-1 (mod n)
@@ -117,6 +132,8 @@ public:
 
   // Specific SecpK1
   static void InitK1(Int *order);
+  static bool SetAdx(bool enable);               // MULX/ADX ModMulK1, false if not supported
+  static bool GetAdx();
   void ModMulK1(Int *a, Int *b);
   void ModMulK1(Int *a);
   void ModSquareK1(Int *a);
@@ -178,6 +195,10 @@ public:
 
 private:
 
+  void ModInvXCD();
+  void ModInvMontgomery();
+  void ModInvPenk();
+  void ModInvDRS62(bool constIter);
   void ShiftL32BitAndSub(Int *a,int n);
   uint64_t AddC(Int *a);
   void AddAndShift(Int *a, Int *b,uint64_t cH);
@@ -188,6 +209,11 @@ private:
 
 };
 
+// ModMulK1 and ModSquareK1 kernels on BMI2 and ADX, see IntMod_adx.cpp
+void modmulk1_adx(uint64_t *r, const uint64_t *a, const uint64_t *b);
+void modsquarek1_adx(uint64_t *r, const uint64_t *a);
+extern bool modK1Adx;   // kernels in use, see Int::SetAdx
+
 // Inline routines
 
 #ifndef WIN64
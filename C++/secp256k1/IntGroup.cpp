@@ -1,10 +1,16 @@
 #include "IntGroup.h"
+#include <stdlib.h>
 
 using namespace std;
 
-IntGroup::IntGroup(int size) {
+IntGroup::IntGroup(int size, int nbChain) {
   this->size = size;
-  subp = (Int *)malloc(size * sizeof(Int));
+  if (nbChain < 1)
+    nbChain = 1;
+  if (nbChain > INTGROUP_MAX_CHAINS)
+    nbChain = INTGROUP_MAX_CHAINS;
+  this->nbChain = nbChain;
+  subp = (Int *)aligned_alloc(64, (size * sizeof(Int) + 63) / 64 * 64);
 }
 
 IntGroup::~IntGroup() {
@@ -15,27 +21,54 @@ void IntGroup::Set(Int *pts) {
   ints = pts;
 }
 
-// Compute modular inversion of the whole group
+// Compute modular inversion of the whole group.
+// Element i is in the prefix product chain i % nbChain, the ModMulK1 of
+// consecutive elements do not wait on each other. The chain products are
+// inverted together with one ModInv.
 void IntGroup::ModInv() {
 
   Int newValue;
   Int inverse;
+  Int chainInv[INTGROUP_MAX_CHAINS];
+  int nb = (nbChain < size) ? nbChain : size;
+  int last = size - nb;
 
-  subp[0].Set(&ints[0]);
-  for (int i = 1; i < size; i++) {
-    subp[i].ModMulK1(&subp[i - 1], &ints[i]);
+  for (int i = 0; i < nb; i++) {
+    subp[i].Set(&ints[i]);
+  }
+  for (int i = nb; i < size; i++) {
+    subp[i].ModMulK1(&subp[i - nb], &ints[i]);
+  }
+
+  // Products of the chains, subp[last..size-1]
+  chainInv[0].Set(&subp[last]);
+  for (int c = 1; c < nb; c++) {
+    chainInv[c].ModMulK1(&chainInv[c - 1], &subp[last + c]);
   }
 
   // Do the inversion
-  inverse.Set(&subp[size - 1]);
+  inverse.Set(&chainInv[nb - 1]);
   inverse.ModInv();
 
-  for (int i = size - 1; i > 0; i--) {
-    newValue.ModMulK1(&subp[i - 1], &inverse);
-    inverse.ModMulK1(&ints[i]);
-    ints[i].Set(&newValue);
+  for (int c = nb - 1; c > 0; c--) {
+    newValue.ModMulK1(&chainInv[c - 1], &inverse);
+    inverse.ModMulK1(&subp[last + c]);
+    chainInv[c].Set(&newValue);
   }
+  chainInv[0].Set(&inverse);
 
-  ints[0].Set(&inverse);
+  // chainInv[c] belongs to the chain of subp[last + c], walked back from
+  // the end of the group
+  int c = nb - 1;
+  for (int i = size - 1; i >= nb; i--) {
+    newValue.ModMulK1(&subp[i - nb], &chainInv[c]);
+    chainInv[c].ModMulK1(&ints[i]);
+    ints[i].Set(&newValue);
+    c = (c == 0) ? nb - 1 : c - 1;
+  }
+  for (int i = nb - 1; i >= 0; i--) {
+    ints[i].Set(&chainInv[c]);
+    c = (c == 0) ? nb - 1 : c - 1;
+  }
 
-}
\ No newline at end of file
+}
@@ -4,11 +4,15 @@
 #include "Int.h"
 #include <vector>
 
+// Independent prefix product chains of ModInv, see IntGroup.cpp
+#define INTGROUP_CHAINS 4
+#define INTGROUP_MAX_CHAINS 8
+
 class IntGroup {
 
 public:
 
-	IntGroup(int size);
+	IntGroup(int size, int nbChain = INTGROUP_CHAINS);
 	~IntGroup();
 	void Set(Int *pts);
 	void ModInv();
@@ -18,6 +22,7 @@ private:
 	Int *ints;
   Int *subp;
   int size;
+  int nbChain;
 
 };
 
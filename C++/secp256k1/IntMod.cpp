@@ -1,6 +1,8 @@
 #include "Int.h"
+#include "../util/Cpu.h"
 #include <emmintrin.h>
 #include <string.h>
+#include <chrono>
 
 #define MAX(x,y) (((x)>(y))?(x):(y))
 #define MIN(x,y) (((x)<(y))?(x):(y))
@@ -14,6 +16,8 @@ static int32_t  Msize;    // Montgomery mult size
 static uint32_t MM32;     // 32bits lsb negative inverse of P
 static uint64_t MM64;     // 64bits lsb negative inverse of P
 #define MSK62  0x3FFFFFFFFFFFFFFF
+#define SAFEGCD_ROUNDS 12  // 744 divsteps >= 741, bound for 256-bit inputs
+static int      modInvMethod = MODINV_DRS62;
 
 extern Int _ONE;
 
@@ -110,7 +114,6 @@ inline void DivStep62(int64_t u0,int64_t v0,
   // Former divstep62 (using __builtin_ctzll)
   // Do not use eta, u and v have an exponential decay in worst case
   // but with low probability to reach this worst case complexity
-  // Avg: 581 Kinv/s
 
   bitCount = 62;
   int64_t nb0;
@@ -151,7 +154,6 @@ inline void DivStep62(int64_t u0,int64_t v0,
 
   // divstep62 var time implementation by Peter Dettman
   // (see https://github.com/bitcoin-core/secp256k1/pull/767)
-  // Avg: 640 Kinv/s
 
   while(true) {
 
@@ -188,12 +190,18 @@ inline void DivStep62(int64_t u0,int64_t v0,
 
 #endif
 
-#if 0
 
-  // divstep62 constant time implementation by Peter Dettman
-  // Avg: 405 Kinv/s
+}
+
+// divstep62 constant time implementation by Peter Dettman : 62 divsteps,
+// same branches and memory accesses for any input
+inline void DivStep62Const(int64_t u0,int64_t v0,
+  int64_t* eta,
+  int64_t* uu,int64_t* uv,
+  int64_t* vu,int64_t* vv) {
 
   uint64_t c1,c2,x,y,z;
+  int bitCount;
 
   for(bitCount = 0; bitCount < 62; bitCount++) {
 
@@ -217,8 +225,6 @@ inline void DivStep62(int64_t u0,int64_t v0,
     *vv += (*uv & c2); *uv <<= 1;
   }
 
-#endif
-
 }
 
 #define MatrixVecMul(u,v,_11,_12,_21,_22) \
@@ -231,23 +237,93 @@ inline void DivStep62(int64_t u0,int64_t v0,
 
 // ------------------------------------------------
 
+// Inverse of this mod _P, 0 < this < P, P must be odd. 0 if no inverse.
+// The variant is selected at run time, bench has a kernel for each.
 void Int::ModInv() {
 
-  // Compute modular inverse of this mop _P
-  // 0 < this < P  , P must be odd
-  // Return 0 if no inverse
+  switch (modInvMethod) {
+  case MODINV_XCD:
+    ModInvXCD();
+    break;
+  case MODINV_MONTGOMERY:
+    ModInvMontgomery();
+    break;
+  case MODINV_PENK:
+    ModInvPenk();
+    break;
+  case MODINV_SAFEGCD62:
+    ModInvDRS62(true);
+    break;
+  default:
+    ModInvDRS62(false);
+    break;
+  }
+
+}
+
+// ------------------------------------------------
+
+void Int::SetModInv(int method) {
+  if (method >= 0 && method < MODINV_NB)
+    modInvMethod = method;
+}
+
+int Int::GetModInv() {
+  return modInvMethod;
+}
+
+const char *Int::GetModInvName(int method) {
+  static const char *names[MODINV_NB] = { "xcd", "montgomery", "penk", "drs62", "safegcd62" };
+  return (method >= 0 && method < MODINV_NB) ? names[method] : "";
+}
+
+int Int::GetModInvMethod(std::string name) {
+  for (int i = 0; i < MODINV_NB; i++)
+    if (name == GetModInvName(i))
+      return i;
+  return -1;
+}
+
+// Times every variant on the same inputs and keeps the fastest
+int Int::SelectModInv() {
+
+  Int in[64], x;
+  in[0].Set(&_P);
+  in[0].SubOne();
+  for (int i = 1; i < 64; i++) {
+    in[i].Set(&in[i - 1]);
+    in[i].ModSquare(&in[i]);
+    in[i].ModAdd((uint64_t)i);
+  }
+
+  int best = MODINV_DRS62;
+  double bestTime = 0;
+  for (int m = 0; m < MODINV_NB; m++) {
+    modInvMethod = m;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64; i++) {
+      x.Set(&in[i]);
+      x.ModInv();
+    }
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (m == 0 || t < bestTime) {
+      best = m;
+      bestTime = t;
+    }
+  }
+  modInvMethod = best;
+  return best;
+
+}
+
+// ------------------------------------------------
 
-  // 256bit
-  //#define XCD 1               // ~80  kOps/s
-  //#define MONTGOMERY 1        // ~246 kOps/s
-  //#define PENK 1              // ~215 kOps/s
-  #define DRS62 1               // ~640 kOps/s
+// Classic extended Euclid
+void Int::ModInvXCD() {
 
   Int u(&_P);
   Int v(this);
 
-#ifdef XCD
-
   Int r((int64_t)0);
   Int s((int64_t)1);
   Int q, t1, t2, w;
@@ -283,9 +359,15 @@ void Int::ModInv() {
     Set(&s);  /* inv = u1     */
   }
 
-#endif
+}
+
+// ------------------------------------------------
 
-#ifdef PENK
+// Penk's algorithm with DRS2
+void Int::ModInvPenk() {
+
+  Int u(&_P);
+  Int v(this);
 
   Int r((int64_t)0);
   Int s((int64_t)1);
@@ -404,9 +486,15 @@ void Int::ModInv() {
     r.Add(&_P);
   Set(&r);
 
-#endif
+}
+
+// ------------------------------------------------
 
-#ifdef MONTGOMERY
+// Montgomery binary inverse
+void Int::ModInvMontgomery() {
+
+  Int u(&_P);
+  Int v(this);
 
   Int r((int64_t)0);
   Int s((int64_t)1);
@@ -455,9 +543,16 @@ void Int::ModInv() {
   }
   Set(&r);
 
-#endif
+}
 
-#ifdef DRS62
+// ------------------------------------------------
+
+// Delayed right shift 62 bits, Bernstein-Yang divsteps in blocks of 62.
+// constIter : constant number of blocks and constant time divsteps (safegcd)
+void Int::ModInvDRS62(bool constIter) {
+
+  Int u(&_P);
+  Int v(this);
 
   // Delayed right shift 62bits
   Int r;
@@ -469,14 +564,14 @@ void Int::ModInv() {
   int64_t uu, uv, vu, vv;
   int64_t eta = -1;
 
-  //printf("ModInv(%s)\n",GetBase16().c_str());
-
-
   //----------------------- First step (r,s) = (1,0)
   uu = 1; uv = 0;
   vu = 0; vv = 1;
 
-  DivStep62(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
+  if (constIter)
+    DivStep62Const(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
+  else
+    DivStep62(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
 
   // Now update BigInt variables
 
@@ -499,12 +594,17 @@ void Int::ModInv() {
   shiftR(62,s.bits64);
 
   //----------------------- DivStep loop
-  while (!v.IsZero()) {
+  // The constant iteration variant always does the 12*62 divsteps of the
+  // 741 bound for 256-bit inputs, u and r do not move once v is 0
+  for (int round = 1; constIter ? round < SAFEGCD_ROUNDS : !v.IsZero(); round++) {
 
     uu =  1; uv = 0;
     vu =  0; vv = 1;
 
-    DivStep62(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
+    if (constIter)
+      DivStep62Const(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
+    else
+      DivStep62(u.bits64[0],v.bits64[0],&eta,&uu,&uv,&vu,&vv);
 
     // Now update BigInt variables
 
@@ -545,8 +645,6 @@ void Int::ModInv() {
     r.Sub(&_P);
   Set(&r);
 
-#endif
-
 }
 
 // ------------------------------------------------
@@ -892,8 +990,33 @@ void Int::MontgomeryMult(Int *a, Int *b) {
 
 // SecpK1 specific section -----------------------------------------------------------------------------
 
+// MULX/ADX kernels when the CPU has BMI2 and ADX, _umul128 and carry chains otherwise
+#ifndef WIN64
+static bool hasAdx = cpu_features().bmi2 && cpu_features().adx;
+#else
+static bool hasAdx = false;
+#endif
+bool modK1Adx = hasAdx;
+
+bool Int::SetAdx(bool enable) {
+  if (enable && !hasAdx)
+    return false;
+  modK1Adx = enable;
+  return true;
+}
+
+bool Int::GetAdx() {
+  return modK1Adx;
+}
+
 void Int::ModMulK1(Int *a, Int *b) {
 
+  if (modK1Adx) {
+    modmulk1_adx(bits64, a->bits64, b->bits64);
+    bits64[4] = 0;
+    return;
+  }
+
 #ifndef WIN64
 #if (__GNUC__ > 7) || (__GNUC__ == 7 && (__GNUC_MINOR__ > 2))
   unsigned char c;
@@ -956,6 +1079,12 @@ void Int::ModMulK1(Int *a, Int *b) {
 
 void Int::ModMulK1(Int *a) {
 
+  if (modK1Adx) {
+    modmulk1_adx(bits64, bits64, a->bits64);
+    bits64[4] = 0;
+    return;
+  }
+
 #ifndef WIN64
 #if (__GNUC__ > 7) || (__GNUC__ == 7 && (__GNUC_MINOR__ > 2))
   unsigned char c;
@@ -1016,6 +1145,12 @@ void Int::ModMulK1(Int *a) {
 
 void Int::ModSquareK1(Int *a) {
 
+  if (modK1Adx) {
+    modsquarek1_adx(bits64, a->bits64);
+    bits64[4] = 0;
+    return;
+  }
+
 #ifndef WIN64
 #if (__GNUC__ > 7) || (__GNUC__ == 7 && (__GNUC_MINOR__ > 2))
   unsigned char c;
@@ -0,0 +1,166 @@
+// ModMulK1 and ModSquareK1 on MULX, ADCX and ADOX (BMI2 and ADX), see Int::SetAdx.
+// ADCX carries in CF only and ADOX in OF only, so the low and high halves of the
+// partial products are added in two independent carry chains.
+// r = a*b mod P (or a^2), a and b below 2^256, r below 2^256 and not
+// always below P like ModMulK1. r may be a or b.
+
+#include "Int.h"
+
+#ifndef WIN64
+
+// a0..a3 += rdx * a[0..3], the low halves on CF and the high ones on OF,
+// a4 (0 before the row) gets the high half of rdx * a[3] and both carries
+#define ADX_ROW(a0, a1, a2, a3, a4)                     \
+  "xorl %k[zero], %k[zero]\n\t"                         \
+  "mulxq 0(%[a]), %[lo], %[hi]\n\t"                     \
+  "adcxq %[lo], %[" #a0 "]\n\t"                         \
+  "adoxq %[hi], %[" #a1 "]\n\t"                         \
+  "mulxq 8(%[a]), %[lo], %[hi]\n\t"                     \
+  "adcxq %[lo], %[" #a1 "]\n\t"                         \
+  "adoxq %[hi], %[" #a2 "]\n\t"                         \
+  "mulxq 16(%[a]), %[lo], %[hi]\n\t"                    \
+  "adcxq %[lo], %[" #a2 "]\n\t"                         \
+  "adoxq %[hi], %[" #a3 "]\n\t"                         \
+  "mulxq 24(%[a]), %[lo], %[" #a4 "]\n\t"               \
+  "adcxq %[lo], %[" #a3 "]\n\t"                         \
+  "adoxq %[zero], %[" #a4 "]\n\t"                       \
+  "adcxq %[zero], %[" #a4 "]\n\t"
+
+// r0..r3 += K * r4..r7, then the word above 2^256 once more as K, and a
+// last carry out of 2^256 as K
+#define ADX_REDUCE                                      \
+  "movq $0x1000003D1, %%rdx\n\t"                        \
+  "xorl %k[zero], %k[zero]\n\t"                         \
+  "mulxq %[r4], %[lo], %[hi]\n\t"                       \
+  "adcxq %[lo], %[r0]\n\t"                              \
+  "adoxq %[hi], %[r1]\n\t"                              \
+  "mulxq %[r5], %[lo], %[hi]\n\t"                       \
+  "adcxq %[lo], %[r1]\n\t"                              \
+  "adoxq %[hi], %[r2]\n\t"                              \
+  "mulxq %[r6], %[lo], %[hi]\n\t"                       \
+  "adcxq %[lo], %[r2]\n\t"                              \
+  "adoxq %[hi], %[r3]\n\t"                              \
+  "mulxq %[r7], %[lo], %[r4]\n\t"                       \
+  "adcxq %[lo], %[r3]\n\t"                              \
+  "adoxq %[zero], %[r4]\n\t"                            \
+  "adcxq %[zero], %[r4]\n\t"                            \
+  "mulxq %[r4], %[lo], %[hi]\n\t"                       \
+  "addq %[lo], %[r0]\n\t"                               \
+  "adcq %[hi], %[r1]\n\t"                               \
+  "adcq $0, %[r2]\n\t"                                  \
+  "adcq $0, %[r3]\n\t"                                  \
+  "sbbq %[lo], %[lo]\n\t"                               \
+  "andq %%rdx, %[lo]\n\t"                               \
+  "addq %[lo], %[r0]\n\t"                               \
+  "adcq $0, %[r1]\n\t"                                  \
+  "adcq $0, %[r2]\n\t"                                  \
+  "adcq $0, %[r3]\n\t"
+
+void modmulk1_adx(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+
+  uint64_t r0, r1, r2, r3, r4, r5, r6, r7, lo, hi, zero;
+
+  __asm__(
+    "xorl %k[r0], %k[r0]\n\t"
+    "xorl %k[r1], %k[r1]\n\t"
+    "xorl %k[r2], %k[r2]\n\t"
+    "xorl %k[r3], %k[r3]\n\t"
+    "movq 0(%[b]), %%rdx\n\t"
+    ADX_ROW(r0, r1, r2, r3, r4)
+    "movq 8(%[b]), %%rdx\n\t"
+    ADX_ROW(r1, r2, r3, r4, r5)
+    "movq 16(%[b]), %%rdx\n\t"
+    ADX_ROW(r2, r3, r4, r5, r6)
+    "movq 24(%[b]), %%rdx\n\t"
+    ADX_ROW(r3, r4, r5, r6, r7)
+    ADX_REDUCE
+    : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2), [r3] "=&r"(r3),
+      [r4] "=&r"(r4), [r5] "=&r"(r5), [r6] "=&r"(r6), [r7] "=&r"(r7),
+      [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero)
+    : [a] "r"(a), [b] "r"(b),
+      "m"(*(const uint64_t(*)[4])a), "m"(*(const uint64_t(*)[4])b)
+    : "rdx", "cc");
+
+  r[0] = r0;
+  r[1] = r1;
+  r[2] = r2;
+  r[3] = r3;
+
+}
+
+// Cross products once, then doubled on CF while the squares of the limbs
+// are added on OF
+void modsquarek1_adx(uint64_t *r, const uint64_t *a) {
+
+  uint64_t r0, r1, r2, r3, r4, r5, r6, r7, lo, hi, zero;
+
+  __asm__(
+    "movq 0(%[a]), %%rdx\n\t"
+    "mulxq 8(%[a]), %[r1], %[r2]\n\t"
+    "mulxq 16(%[a]), %[lo], %[r3]\n\t"
+    "mulxq 24(%[a]), %[hi], %[r4]\n\t"
+    "addq %[lo], %[r2]\n\t"
+    "adcq %[hi], %[r3]\n\t"
+    "adcq $0, %[r4]\n\t"
+    "movq 8(%[a]), %%rdx\n\t"
+    "xorl %k[zero], %k[zero]\n\t"
+    "mulxq 16(%[a]), %[lo], %[hi]\n\t"
+    "adcxq %[lo], %[r3]\n\t"
+    "adoxq %[hi], %[r4]\n\t"
+    "mulxq 24(%[a]), %[lo], %[r5]\n\t"
+    "adcxq %[lo], %[r4]\n\t"
+    "adoxq %[zero], %[r5]\n\t"
+    "adcxq %[zero], %[r5]\n\t"
+    "movq 16(%[a]), %%rdx\n\t"
+    "mulxq 24(%[a]), %[lo], %[r6]\n\t"
+    "addq %[lo], %[r5]\n\t"
+    "adcq $0, %[r6]\n\t"
+    "xorl %k[r7], %k[r7]\n\t"
+    "movq 0(%[a]), %%rdx\n\t"
+    "mulxq %%rdx, %[r0], %[hi]\n\t"
+    "adcxq %[r1], %[r1]\n\t"
+    "adoxq %[hi], %[r1]\n\t"
+    "movq 8(%[a]), %%rdx\n\t"
+    "mulxq %%rdx, %[lo], %[hi]\n\t"
+    "adcxq %[r2], %[r2]\n\t"
+    "adoxq %[lo], %[r2]\n\t"
+    "adcxq %[r3], %[r3]\n\t"
+    "adoxq %[hi], %[r3]\n\t"
+    "movq 16(%[a]), %%rdx\n\t"
+    "mulxq %%rdx, %[lo], %[hi]\n\t"
+    "adcxq %[r4], %[r4]\n\t"
+    "adoxq %[lo], %[r4]\n\t"
+    "adcxq %[r5], %[r5]\n\t"
+    "adoxq %[hi], %[r5]\n\t"
+    "movq 24(%[a]), %%rdx\n\t"
+    "mulxq %%rdx, %[lo], %[hi]\n\t"
+    "adcxq %[r6], %[r6]\n\t"
+    "adoxq %[lo], %[r6]\n\t"
+    "adcxq %[r7], %[r7]\n\t"
+    "adoxq %[hi], %[r7]\n\t"
+    ADX_REDUCE
+    : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2), [r3] "=&r"(r3),
+      [r4] "=&r"(r4), [r5] "=&r"(r5), [r6] "=&r"(r6), [r7] "=&r"(r7),
+      [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero)
+    : [a] "r"(a),
+      "m"(*(const uint64_t(*)[4])a)
+    : "rdx", "cc");
+
+  r[0] = r0;
+  r[1] = r1;
+  r[2] = r2;
+  r[3] = r3;
+
+}
+
+#else
+
+// No inline asm here, modK1Adx stays false and these are not called
+
+void modmulk1_adx(uint64_t *r, const uint64_t *a, const uint64_t *b) {
+}
+
+void modsquarek1_adx(uint64_t *r, const uint64_t *a) {
+}
+
+#endif
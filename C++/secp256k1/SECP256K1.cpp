@@ -3,12 +3,40 @@
 #include "../hash/ripemd160.h"
 #include "../base58/Base58.h"
 #include "../bech32/Bech32.h"
+#include "IntGroup.h"
 #include <string.h>
+#include <stdio.h>
+#ifdef WIN64
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Generator table cache file : header then the 256*32 points of GTable as
+// they are in memory, the header holds the SHA-256 of the points
+#define GTABLE_MAGIC   "GTABLE02"
+#define GTABLE_SIZE    (256*32)
+
+struct GTableHeader {
+  char magic[8];
+  uint32_t nbPoint;
+  uint32_t pointSize;
+  uint8_t checksum[32];
+  uint8_t pad[16];           // Points start 64-byte aligned
+};
 
 Secp256K1::Secp256K1() {
+  gWindow = 8;
+  GTable = GTableData;
+  gTableSource = GTABLE_COMPUTED;
+  gTableMap = NULL;
 }
 
-void Secp256K1::Init() {
+void Secp256K1::Init(std::string gTableCache) {
 
   // Prime for the finite field
   Int P;
@@ -25,21 +53,157 @@ void Secp256K1::Init() {
 
   Int::InitK1(&order);
 
-  // Compute Generator table
-  Point N(G);
-  for(int i = 0; i < 32; i++) {
-    GTable[i * 256] = N;
-    N = DoubleDirect(N);
-    for (int j = 1; j < 255; j++) {
-      GTable[i * 256 + j] = N;
-      N = AddDirect(N, GTable[i * 256]);
-    }
-    GTable[i * 256 + 255] = N; // Dummy point for check function
+  // Generator table, from the cache when it is valid
+  if (!gTableCache.empty() && MapGTable(gTableCache)) {
+    gTableSource = GTABLE_MAPPED;
+    return;
   }
+  BuildGTable(GTableData, 8, 32);
+  gTableSource = GTABLE_COMPUTED;
+  if (!gTableCache.empty() && SaveGTable(gTableCache))
+    gTableSource = GTABLE_SAVED;
 
 }
 
 Secp256K1::~Secp256K1() {
+#ifndef WIN64
+  if (gTableMap)
+    munmap(gTableMap, sizeof(GTableHeader) + GTABLE_SIZE * sizeof(AffinePoint));
+#endif
+}
+
+int Secp256K1::GetGTableSource() {
+  return gTableSource;
+}
+
+// Window i holds j*2^(w*i)G for j in [1,2^w-1], the last slot 2^(w*(i+1))G
+// is a dummy for the check function. Points are summed in projective
+// coordinates and normalized with one inversion per window.
+void Secp256K1::BuildGTable(AffinePoint *table, int windowBits, int nbWindow) {
+
+  int size = 1 << windowBits;
+  std::vector<Point> T(size);
+  std::vector<Int> z(size - 1);
+  IntGroup group(size - 1);
+  group.Set(z.data());
+  Point B(G);
+
+  for (int i = 0; i < nbWindow; i++) {
+    AffinePoint *A = table + (size_t)i * size;
+    T[0] = B;
+    T[1] = DoubleDirect(B);
+    for (int j = 2; j < size - 1; j++)
+      T[j] = Add2(T[j - 1], B);
+    for (int j = 0; j < size - 1; j++)
+      z[j].Set(&T[j].z);
+    group.ModInv();
+    for (int j = 0; j < size - 1; j++) {
+      T[j].x.ModMulK1(&z[j]);
+      T[j].y.ModMulK1(&z[j]);
+      T[j].z.SetInt32(1);
+      A[j].Set(&T[j]);
+    }
+    B = AddDirect(T[size - 2], B);
+    A[size - 1].Set(&B);
+  }
+
+}
+
+// Maps the cache read-only, pages are shared by the processes using it.
+// A file with an other layout or checksum is ignored.
+bool Secp256K1::MapGTable(std::string fileName) {
+
+  size_t dataSize = GTABLE_SIZE * sizeof(AffinePoint);
+  size_t fileSize = sizeof(GTableHeader) + dataSize;
+  uint8_t digest[32];
+
+#ifdef WIN64
+
+  FILE *f = fopen(fileName.c_str(), "rb");
+  if (f == NULL)
+    return false;
+  GTableHeader h;
+  bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, GTABLE_MAGIC, 8) == 0 &&
+            h.nbPoint == GTABLE_SIZE && h.pointSize == sizeof(AffinePoint) &&
+            fread(GTableData, sizeof(AffinePoint), GTABLE_SIZE, f) == GTABLE_SIZE;
+  fclose(f);
+  if (ok) {
+    sha256((uint8_t *)GTableData, (int)dataSize, digest);
+    ok = memcmp(digest, h.checksum, 32) == 0;
+  }
+  return ok;
+
+#else
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size != fileSize) {
+    close(fd);
+    return false;
+  }
+  void *map = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  GTableHeader *h = (GTableHeader *)map;
+  AffinePoint *table = (AffinePoint *)((uint8_t *)map + sizeof(GTableHeader));
+  bool ok = memcmp(h->magic, GTABLE_MAGIC, 8) == 0 && h->nbPoint == GTABLE_SIZE &&
+            h->pointSize == sizeof(AffinePoint);
+  if (ok) {
+    sha256((uint8_t *)table, (int)dataSize, digest);
+    ok = memcmp(digest, h->checksum, 32) == 0;
+  }
+  if (!ok) {
+    munmap(map, fileSize);
+    return false;
+  }
+  gTableMap = map;
+  GTable = table;
+  return true;
+
+#endif
+
+}
+
+// Written to a file of this process then renamed, so processes starting
+// together never map a partial table
+bool Secp256K1::SaveGTable(std::string fileName) {
+
+  size_t dataSize = GTABLE_SIZE * sizeof(AffinePoint);
+  GTableHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, GTABLE_MAGIC, 8);
+  h.nbPoint = GTABLE_SIZE;
+  h.pointSize = sizeof(AffinePoint);
+  sha256((uint8_t *)GTableData, (int)dataSize, h.checksum);
+
+#ifdef WIN64
+  std::string tmpName = fileName + ".tmp" + std::to_string(_getpid());
+#else
+  std::string tmpName = fileName + ".tmp" + std::to_string(getpid());
+#endif
+  FILE *f = fopen(tmpName.c_str(), "wb");
+  if (f == NULL)
+    return false;
+  bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+            fwrite(GTableData, sizeof(AffinePoint), GTABLE_SIZE, f) == GTABLE_SIZE;
+  ok = fclose(f) == 0 && ok;
+  if (!ok) {
+    remove(tmpName.c_str());
+    return false;
+  }
+#ifdef WIN64
+  remove(fileName.c_str());
+#endif
+  if (rename(tmpName.c_str(), fileName.c_str()) != 0) {
+    remove(tmpName.c_str());
+    return false;
+  }
+  return true;
+
 }
 
 void PrintResult(bool ok) {
@@ -51,33 +215,127 @@ void PrintResult(bool ok) {
   }
 }
 
-Point Secp256K1::ComputePublicKey(Int *privKey) {
+// Projective sum of the table points of the key windows
+void Secp256K1::SumGTable(Int *privKey, Point *out) {
 
   int i = 0;
   uint8_t b;
-  Point Q;
+  Point &Q = *out;
+  Point T;
   Q.Clear();
 
-  // Search first significant byte
-  for (i = 0; i < 32; i++) {
-    b = privKey->GetByte(i);
-    if(b)
-      break;
+  if (gWindow == 8) {
+
+    // Search first significant byte, a zero key is left cleared (z = 0)
+    for (i = 0; i < 32; i++) {
+      b = privKey->GetByte(i);
+      if(b)
+        break;
+    }
+    if (i == 32)
+      return;
+    GTable[256 * i + (b-1)].Get(&Q);
+    i++;
+
+    for(; i < 32; i++) {
+      b = privKey->GetByte(i);
+      if(b) {
+        GTable[256 * i + (b-1)].Get(&T);
+        Add2Into(&Q, Q, T);
+      }
+    }
+
+    return;
+
   }
-  Q = GTable[256 * i + (b-1)];
-  i++;
 
-  for(; i < 32; i++) {
-    b = privKey->GetByte(i);
-    if(b)
-      Q = Add2(Q, GTable[256 * i + (b-1)]);
+  int nbWindow = (256 + gWindow - 1) / gWindow;
+  uint64_t mask = (1ULL << gWindow) - 1;
+  bool first = true;
+  for (i = 0; i < nbWindow; i++) {
+    int pos = i * gWindow;
+    uint64_t w = privKey->bits64[pos / 64] >> (pos % 64);
+    if (pos % 64 + gWindow > 64)
+      w |= privKey->bits64[pos / 64 + 1] << (64 - pos % 64);
+    w &= mask;
+    if (!w)
+      continue;
+    AffinePoint &A = GTableWide[(i << gWindow) + (w - 1)];
+    if (first) {
+      A.Get(&Q);
+    } else {
+      A.Get(&T);
+      Add2Into(&Q, Q, T);
+    }
+    first = false;
   }
 
-  Q.Reduce();
+}
+
+Point Secp256K1::ComputePublicKey(Int *privKey) {
+
+  Point Q;
+  ComputePublicKey(privKey, &Q);
   return Q;
 
 }
 
+void Secp256K1::ComputePublicKey(Int *privKey, Point *out) {
+
+  SumGTable(privKey, out);
+  out->Reduce();
+
+}
+
+void Secp256K1::ComputePublicKeyBatch(Int *privKeys, int n, Point *out) {
+
+  if (n <= 0)
+    return;
+
+  std::vector<Int> z(n);
+  for (int i = 0; i < n; i++) {
+    SumGTable(privKeys + i, out + i);
+    z[i].Set(&out[i].z);
+    // Zero key, keeps the other inverses valid
+    if (z[i].IsZero())
+      z[i].SetInt32(1);
+  }
+
+  IntGroup group(n);
+  group.Set(z.data());
+  group.ModInv();
+
+  for (int i = 0; i < n; i++) {
+    out[i].x.ModMulK1(&z[i]);
+    out[i].y.ModMulK1(&z[i]);
+    out[i].z.SetInt32(1);
+  }
+
+}
+
+int Secp256K1::GetGTableWindow() {
+  return gWindow;
+}
+
+void Secp256K1::SetGTableWindow(int windowBits) {
+
+  if (windowBits <= 8) {
+    gWindow = 8;
+    GTableWide.clear();
+    return;
+  }
+  if (windowBits > 16)
+    windowBits = 16;
+
+  int size = 1 << windowBits;
+  int nbWindow = (256 + windowBits - 1) / windowBits;
+  GTableWide.resize((size_t)nbWindow * size);
+  BuildGTable(GTableWide.data(), windowBits, nbWindow);
+
+  gWindow = windowBits;
+
+}
+
 Point Secp256K1::NextKey(Point &key) {
   // Input key must be reduced and different from G
   // in order to use AddDirect
@@ -270,7 +528,7 @@ Point Secp256K1::ParsePublicKeyHex(std::string str, bool &isCompressed) {
       }
       for (int i = 0; i < 32; i++)
         ret.x.SetByte(31 - i, GetByte(str, i + 1));
-      ret.y = GetY(ret.x, true);
+      GetYToX(&ret.x, true, &ret.y);
       isCompressed = true;
       break;
 
@@ -281,7 +539,7 @@ Point Secp256K1::ParsePublicKeyHex(std::string str, bool &isCompressed) {
       }
       for (int i = 0; i < 32; i++)
         ret.x.SetByte(31 - i, GetByte(str, i + 1));
-      ret.y = GetY(ret.x, false);
+      GetYToX(&ret.x, false, &ret.y);
       isCompressed = true;
       break;
 
@@ -336,7 +594,7 @@ Point Secp256K1::ParsePublicKeyHex2(char* pubkey) {
       }
       for (int i = 0; i < 32; i++)
         ret.x.SetByte(31 - i, GetByte(str, i + 1));
-      ret.y = GetY(ret.x, true);
+      GetYToX(&ret.x, true, &ret.y);
       break;
 
     case 0x03:
@@ -346,7 +604,7 @@ Point Secp256K1::ParsePublicKeyHex2(char* pubkey) {
       }
       for (int i = 0; i < 32; i++)
         ret.x.SetByte(31 - i, GetByte(str, i + 1));
-      ret.y = GetY(ret.x, false);
+      GetYToX(&ret.x, false, &ret.y);
       break;
 
     case 0x04:
@@ -520,6 +778,101 @@ void Secp256K1::GetHash160(int type, bool compressed, Point &pubKey, unsigned ch
 
 }
 
+// Keys are hashed by blocks so the intermediate buffers stay on the stack
+#define HASH_BLOCK_SIZE 64
+
+void Secp256K1::GetHash160Batch(Point *points, int n, bool compressed, unsigned char *out) {
+
+  unsigned char msg[HASH_BLOCK_SIZE * 65];
+  unsigned char shapk[HASH_BLOCK_SIZE * 32];
+
+  for (int b = 0; b < n; b += HASH_BLOCK_SIZE) {
+
+    int nb = (n - b < HASH_BLOCK_SIZE) ? n - b : HASH_BLOCK_SIZE;
+    Point *p = points + b;
+
+    if (compressed) {
+      // Packed 33-byte keys, x written from its limbs as big endian words
+      for (int i = 0; i < nb; i++) {
+        unsigned char *m = msg + 33 * i;
+        m[0] = p[i].y.IsEven() ? 0x2 : 0x3;
+        p[i].x.Get32Bytes(m + 1);
+      }
+      sha256_33_batch(msg, nb, shapk);
+    } else {
+      // Packed 65-byte keys
+      for (int i = 0; i < nb; i++) {
+        unsigned char *m = msg + 65 * i;
+        m[0] = 0x4;
+        p[i].x.Get32Bytes(m + 1);
+        p[i].y.Get32Bytes(m + 33);
+      }
+      sha256_65_batch(msg, nb, shapk);
+    }
+
+    ripemd160_32_batch(shapk, nb, out + 20 * b);
+
+  }
+
+}
+
+void Secp256K1::GetHash160Batch(AffinePoint *points, int n, bool compressed, unsigned char *out) {
+
+  unsigned char msg[HASH_BLOCK_SIZE * 65];
+  unsigned char shapk[HASH_BLOCK_SIZE * 32];
+
+  for (int b = 0; b < n; b += HASH_BLOCK_SIZE) {
+
+    int nb = (n - b < HASH_BLOCK_SIZE) ? n - b : HASH_BLOCK_SIZE;
+    AffinePoint *p = points + b;
+
+    if (compressed) {
+      for (int i = 0; i < nb; i++) {
+        unsigned char *m = msg + 33 * i;
+        m[0] = p[i].IsYEven() ? 0x2 : 0x3;
+        p[i].GetXBytes(m + 1);
+      }
+      sha256_33_batch(msg, nb, shapk);
+    } else {
+      for (int i = 0; i < nb; i++) {
+        unsigned char *m = msg + 65 * i;
+        m[0] = 0x4;
+        p[i].GetXBytes(m + 1);
+        p[i].GetYBytes(m + 33);
+      }
+      sha256_65_batch(msg, nb, shapk);
+    }
+
+    ripemd160_32_batch(shapk, nb, out + 20 * b);
+
+  }
+
+}
+
+void Secp256K1::GetP2SHHash160Batch(unsigned char *hash160, int n, unsigned char *out) {
+
+  unsigned char script[HASH_BLOCK_SIZE * 22];
+  unsigned char shapk[HASH_BLOCK_SIZE * 32];
+
+  for (int b = 0; b < n; b += HASH_BLOCK_SIZE) {
+
+    int nb = (n - b < HASH_BLOCK_SIZE) ? n - b : HASH_BLOCK_SIZE;
+
+    // Redeem Script (1 to 1 P2SH) : OP_0 PUSH20 <hash160>
+    for (int i = 0; i < nb; i++) {
+      unsigned char *s = script + 22 * i;
+      s[0] = 0x00;
+      s[1] = 0x14;
+      memcpy(s + 2, hash160 + 20 * (b + i), 20);
+    }
+
+    sha256_short_batch(script, 22, nb, shapk);
+    ripemd160_32_batch(shapk, nb, out + 20 * b);
+
+  }
+
+}
+
 std::string Secp256K1::GetPrivAddress(bool compressed, Int &privKey) {
 
   unsigned char address[38];
@@ -660,53 +1013,54 @@ Point Secp256K1::PointMultiplication(Point &P, Int *scalar) {
   return R;
 }
 
-Point Secp256K1::AddDirect(Point &p1, Point &p2) {
+Point Secp256K1::AddDirect(const Point &p1, const Point &p2) {
 
-  Int _s;
-  Int _p;
-  Int dy;
-  Int dx;
   Point r;
-  r.z.SetInt32(1);
+  AddPointsInto(&r, p1, p2);
+  return r;
 
-  dy.ModSub(&p2.y, &p1.y);
-  dx.ModSub(&p2.x, &p1.x);
-  dx.ModInv();
-  _s.ModMulK1(&dy, &dx);     // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
+}
 
-  _p.ModSquareK1(&_s);       // _p = pow2(s)
+Point Secp256K1::AddPoints(const Point &p1, const Point &p2) {
 
-  r.x.ModSub(&_p, &p1.x);
-  r.x.ModSub(&p2.x);       // rx = pow2(s) - p1.x - p2.x;
+  Point r;
+  AddPointsInto(&r, p1, p2);
+  return r;
 
-  r.y.ModSub(&p2.x, &r.x);
-  r.y.ModMulK1(&_s);
-  r.y.ModSub(&p2.y);       // ry = - p2.y - s*(ret.x-p2.x);
+}
 
-  return r;
+void Secp256K1::AddPointsInto(Point *out, const Point &p1, const Point &p2) {
+  // Int takes its operands by pointer, they are only read
+  AddAffineInto(out, (Int *)&p1.x, (Int *)&p1.y, (Int *)&p2.x, (Int *)&p2.y);
+}
 
+void Secp256K1::SubtractPointsInto(Point *out, const Point &p1, const Point &p2) {
+  Int y2((Int *)&p2.y);
+  y2.ModNeg();
+  AddAffineInto(out, (Int *)&p1.x, (Int *)&p1.y, (Int *)&p2.x, &y2);
 }
 
-Point Secp256K1::AddPoints(Point &p1, Point &p2) {
+// (x1,y1) + (x2,y2), the result is written once every operand is read
+void Secp256K1::AddAffineInto(Point *out, Int *x1, Int *y1, Int *x2, Int *y2) {
 
-  Int _s, dx, dy;
-  Point r;
-  r.z.SetInt32(1);
+  Int _s, dx, dy, rx;
 
-  dy.ModSub(&p2.y, &p1.y);
-  dx.ModSub(&p2.x, &p1.x);
+  dy.ModSub(y2, y1);
+  dx.ModSub(x2, x1);
   dx.ModInv();
   _s.ModMulK1(&dy, &dx);     // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
 
-  r.x.ModSquareK1(&_s);       // _p = pow2(s)
-  r.x.ModSub(&p1.x);
-  r.x.ModSub(&p2.x);       // rx = pow2(s) - p1.x - p2.x;
+  rx.ModSquareK1(&_s);       // _p = pow2(s)
+  rx.ModSub(x1);
+  rx.ModSub(x2);             // rx = pow2(s) - p1.x - p2.x;
 
-  r.y.ModSub(&p2.x, &r.x);
-  r.y.ModMulK1(&_s);
-  r.y.ModSub(&p2.y);       // ry = - p2.y - s*(ret.x-p2.x);
+  dy.ModSub(x2, &rx);
+  dy.ModMulK1(&_s);
+  dy.ModSub(y2);             // ry = - p2.y - s*(ret.x-p2.x);
 
-  return r;
+  out->x.Set(&rx);
+  out->y.Set(&dy);
+  out->z.SetInt32(1);
 
 }
 
@@ -758,13 +1112,10 @@ Point Secp256K1::AddPoints2(Point &p1, Point &p2) {
 
 }
 
-Point Secp256K1::SubtractPoints(Point &p1, Point &p2) {
-  Point Q1, Q2;
-  Q1.Set(p2);
-  Q1.y.ModNeg();
-  Q1.z.SetInt32(1);
-  Q2 = AddPoints(p1, Q1);
-  return Q2;
+Point Secp256K1::SubtractPoints(const Point &p1, const Point &p2) {
+  Point r;
+  SubtractPointsInto(&r, p1, p2);
+  return r;
 }
 
 Point Secp256K1::SubtractPoints2(Point &p1, Point &p2) {
@@ -776,7 +1127,15 @@ Point Secp256K1::SubtractPoints2(Point &p1, Point &p2) {
   return Q2;
 }
 
-Point Secp256K1::Add2(Point &p1, Point &p2) {
+Point Secp256K1::Add2(const Point &p1, const Point &p2) {
+  Point r;
+  Add2Into(&r, p1, p2);
+  return r;
+}
+
+// out may be p1 or p2 : p2 is read first, p1.x and p1.y before out->x and
+// out->y are written, p1.z last
+void Secp256K1::Add2Into(Point *out, const Point &p1, const Point &p2) {
 
   // P2.z = 1
 
@@ -792,31 +1151,30 @@ Point Secp256K1::Add2(Point &p1, Point &p2) {
   Int vs2v2;
   Int vs3u2;
   Int _2vs2v2;
-  Point r;
+  Int *x1 = (Int *)&p1.x, *y1 = (Int *)&p1.y, *z1 = (Int *)&p1.z;
+  Point &r = *out;
 
-  u1.ModMulK1(&p2.y, &p1.z);
-  v1.ModMulK1(&p2.x, &p1.z);
-  u.ModSub(&u1, &p1.y);
-  v.ModSub(&v1, &p1.x);
+  u1.ModMulK1((Int *)&p2.y, z1);
+  v1.ModMulK1((Int *)&p2.x, z1);
+  u.ModSub(&u1, y1);
+  v.ModSub(&v1, x1);
   us2.ModSquareK1(&u);
   vs2.ModSquareK1(&v);
   vs3.ModMulK1(&vs2, &v);
-  us2w.ModMulK1(&us2, &p1.z);
-  vs2v2.ModMulK1(&vs2, &p1.x);
+  us2w.ModMulK1(&us2, z1);
+  vs2v2.ModMulK1(&vs2, x1);
   _2vs2v2.ModAdd(&vs2v2, &vs2v2);
   a.ModSub(&us2w, &vs3);
   a.ModSub(&_2vs2v2);
 
   r.x.ModMulK1(&v, &a);
 
-  vs3u2.ModMulK1(&vs3, &p1.y);
+  vs3u2.ModMulK1(&vs3, y1);
   r.y.ModSub(&vs2v2, &a);
   r.y.ModMulK1(&r.y, &u);
   r.y.ModSub(&vs3u2);
 
-  r.z.ModMulK1(&vs3, &p1.z);
-
-  return r;
+  r.z.ModMulK1(&vs3, z1);
 
 }
 
@@ -889,34 +1247,41 @@ Point Secp256K1::Add(Point &p1,Point &p2) {
   return r;
 }
 
-Point Secp256K1::DoubleDirect(Point &p) {
+Point Secp256K1::DoubleDirect(const Point &p) {
+  Point r;
+  DoubleDirectInto(&r, p);
+  return r;
+}
+
+void Secp256K1::DoubleDirectInto(Point *out, const Point &p) {
 
   Int _s;
   Int _p;
   Int a;
-  Point r;
-  r.z.SetInt32(1);
+  Int rx;
+  Int *px = (Int *)&p.x, *py = (Int *)&p.y;
 
-  _s.ModMulK1(&p.x, &p.x);
+  _s.ModMulK1(px, px);
   _p.ModAdd(&_s, &_s);
   _p.ModAdd(&_s);
 
-  a.ModAdd(&p.y, &p.y);
+  a.ModAdd(py, py);
   a.ModInv();
   _s.ModMulK1(&_p, &a);     // s = (3*pow2(p.x))*inverse(2*p.y);
 
   _p.ModMulK1(&_s, &_s);
-  a.ModAdd(&p.x, &p.x);
+  a.ModAdd(px, px);
   a.ModNeg();
-  r.x.ModAdd(&a, &_p);    // rx = pow2(s) + neg(2*p.x);
+  rx.ModAdd(&a, &_p);    // rx = pow2(s) + neg(2*p.x);
 
-  a.ModSub(&r.x, &p.x);
+  a.ModSub(&rx, px);
 
   _p.ModMulK1(&a, &_s);
-  r.y.ModAdd(&_p, &p.y);
-  r.y.ModNeg();           // ry = neg(p.y + s*(ret.x+neg(p.x)));
+  out->y.ModAdd(&_p, py);
+  out->y.ModNeg();           // ry = neg(p.y + s*(ret.x+neg(p.x)));
+  out->x.Set(&rx);
+  out->z.SetInt32(1);
 
-  return r;
 }
 
 Point Secp256K1::Double(Point &p) {
@@ -987,34 +1352,14 @@ Point Secp256K1::Double(Point &p) {
   return r;
 }
 
-Int Secp256K1::GetY(Int x, bool isEven) {
-
-  Int _s;
-  Int _p;
-
-  _s.ModSquareK1(&x);
-  _p.ModMulK1(&_s,&x);
-  _p.ModAdd(7);
-  _p.ModSqrt();
-
-  if(!_p.IsEven() && isEven) {
-    _p.ModNeg();
-  }
-  else if(_p.IsEven() && !isEven) {
-    _p.ModNeg();
-  }
-
-  return _p;
-
-}
-
-Int Secp256K1::GetYToX(Int x, bool isEven) {
+// Root of x^3+7 of the given parity
+void Secp256K1::GetYToX(const Int *x, bool isEven, Int *y) {
 
   Int _s;
   Int _p;
 
-  _s.ModSquareK1(&x);
-  _p.ModMulK1(&_s,&x);
+  _s.ModSquareK1((Int *)x);
+  _p.ModMulK1(&_s,(Int *)x);
   _p.ModAdd(7);
   _p.ModSqrt();
 
@@ -1025,7 +1370,7 @@ Int Secp256K1::GetYToX(Int x, bool isEven) {
     _p.ModNeg();
   }
 
-  return _p;
+  y->Set(&_p);
 
 }
 
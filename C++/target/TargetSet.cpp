@@ -0,0 +1,228 @@
+#include "TargetSet.h"
+#include <fstream>
+#include <chrono>
+#include "../util/util.h"
+#include "../base58/Base58.h"
+#include "../bech32/Bech32.h"
+#include "../hash/sha256.h"
+#include <algorithm>
+#include <stdlib.h>
+
+static bool Hash160Lower(const Hash160 &a, const Hash160 &b) {
+  return memcmp(a.h, b.h, 20) < 0;
+}
+
+static bool Hash160Equal(const Hash160 &a, const Hash160 &b) {
+  return memcmp(a.h, b.h, 20) == 0;
+}
+
+TargetSet::TargetSet() {
+  filter = NULL;
+  nbBlocks = 0;
+  blockMask = 0;
+  nbInvalid = 0;
+}
+
+TargetSet::~TargetSet() {
+  free(filter);
+}
+
+static int HexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool TargetSet::ParseHash160(std::string hex, uint8_t *hash160) {
+
+  if (hex.length() != 40)
+    return false;
+
+  for (int i = 0; i < 20; i++) {
+    int hi = HexDigit(hex[2 * i]);
+    int lo = HexDigit(hex[2 * i + 1]);
+    if (hi < 0 || lo < 0)
+      return false;
+    hash160[i] = (uint8_t)(hi << 4 | lo);
+  }
+
+  return true;
+
+}
+
+bool TargetSet::LoadFile(std::string fileName, int type) {
+
+  std::ifstream inFile(fileName);
+  if (!inFile.is_open())
+    return false;
+
+  std::string line;
+  uint8_t hash160[20];
+  int lineType;
+  while (getline(inFile, line)) {
+    if (line.find_first_not_of(" \t\r\n") == std::string::npos)
+      continue;
+    line = trim(line);
+    if (line[0] == '#')
+      continue;
+    if (!ParseTarget(line, hash160, &lineType))
+      nbInvalid++;
+    else if (lineType == type)
+      Add(hash160);
+  }
+  inFile.close();
+
+  return true;
+
+}
+
+bool TargetSet::LoadPublicKeys(std::string fileName, Secp256K1 *secp, std::vector<Point> &keys) {
+
+  std::ifstream inFile(fileName);
+  if (!inFile.is_open())
+    return false;
+
+  std::string line;
+  uint8_t x[20];
+  int type;
+  while (getline(inFile, line)) {
+    if (line.find_first_not_of(" \t\r\n") == std::string::npos)
+      continue;
+    line = trim(line);
+    if (!ParseTarget(line, x, &type) || type != PUBKEY)
+      continue;
+    // Same point as ParsePublicKeyHex, which exits on a point off the curve :
+    // those are skipped here
+    Point p;
+    p.Clear();
+    for (int i = 0; i < 32; i++)
+      p.x.SetByte(31 - i, (uint8_t)(HexDigit(line[2 + 2 * i]) << 4 | HexDigit(line[3 + 2 * i])));
+    if (line.length() == 66) {
+      Secp256K1::GetYToX(&p.x, line[1] == '2', &p.y);
+    } else {
+      for (int i = 0; i < 32; i++)
+        p.y.SetByte(31 - i, (uint8_t)(HexDigit(line[66 + 2 * i]) << 4 | HexDigit(line[67 + 2 * i])));
+    }
+    p.z.SetInt32(1);
+    if (secp->EC(p))
+      keys.push_back(p);
+  }
+  inFile.close();
+
+  return true;
+
+}
+
+void TargetSet::Add(uint8_t *hash160) {
+  Hash160 h;
+  memcpy(h.h, hash160, 20);
+  hashes.push_back(h);
+}
+
+void TargetSet::Build() {
+
+  std::sort(hashes.begin(), hashes.end(), Hash160Lower);
+  hashes.erase(std::unique(hashes.begin(), hashes.end(), Hash160Equal), hashes.end());
+
+  // Number of blocks rounded to a power of 2
+  uint64_t nbBits = (uint64_t)hashes.size() * TARGET_BITS_PER_KEY;
+  nbBlocks = 1;
+  while (nbBlocks * TARGET_BLOCK_BITS < nbBits)
+    nbBlocks <<= 1;
+  blockMask = nbBlocks - 1;
+
+  free(filter);
+  size_t size = nbBlocks * TARGET_BLOCK_WORDS * sizeof(uint64_t);
+  filter = (uint64_t *)aligned_alloc(64, size);
+  memset(filter, 0, size);
+
+  for (size_t i = 0; i < hashes.size(); i++) {
+
+    uint32_t w[5];
+    memcpy(w, hashes[i].h, 20);
+
+    uint64_t *block = filter + (w[0] & blockMask) * TARGET_BLOCK_WORDS;
+    uint64_t p0 = ((uint64_t)w[2] << 32) | w[1];
+    uint64_t p1 = ((uint64_t)w[4] << 32) | w[3];
+
+    for (int j = 0; j < TARGET_NB_PROBES / 2; j++) {
+      uint32_t b0 = (uint32_t)(p0 >> (9 * j)) & (TARGET_BLOCK_BITS - 1);
+      uint32_t b1 = (uint32_t)(p1 >> (9 * j)) & (TARGET_BLOCK_BITS - 1);
+      block[b0 >> 6] |= 1ULL << (b0 & 63);
+      block[b1 >> 6] |= 1ULL << (b1 & 63);
+    }
+
+  }
+
+}
+
+bool TargetSet::ContainsExact(uint8_t *hash160) {
+  Hash160 h;
+  memcpy(h.h, hash160, 20);
+  return std::binary_search(hashes.begin(), hashes.end(), h, Hash160Lower);
+}
+
+size_t TargetSet::GetSize() {
+  return hashes.size();
+}
+
+size_t TargetSet::GetFilterSize() {
+  return nbBlocks * TARGET_BLOCK_WORDS * sizeof(uint64_t);
+}
+
+size_t TargetSet::GetNbInvalid() {
+  return nbInvalid;
+}
+
+bool TargetSet::ParseTarget(std::string str, uint8_t *hash160, int *type) {
+
+  if (ParseHash160(str, hash160)) {
+    *type = P2PKH;
+    return true;
+  }
+
+  // Public key, 02/03 + x or 04 + x + y. The point itself is checked by
+  // LoadPublicKeys or Secp256K1::ParsePublicKeyHex where it is needed.
+  if ((str.length() == 66 && (str.compare(0, 2, "02") == 0 || str.compare(0, 2, "03") == 0)) ||
+      (str.length() == 130 && str.compare(0, 2, "04") == 0)) {
+    for (size_t i = 2; i < str.length(); i++)
+      if (HexDigit(str[i]) < 0)
+        return false;
+    // x is bytes 1..32 big endian, limb order is little endian
+    for (int i = 0; i < 20; i++)
+      hash160[i] = (uint8_t)(HexDigit(str[64 - 2 * i]) << 4 | HexDigit(str[65 - 2 * i]));
+    *type = PUBKEY;
+    return true;
+  }
+
+  // Segwit v0 key hash
+  if (str.compare(0, 3, "bc1") == 0 || str.compare(0, 3, "BC1") == 0) {
+    int version;
+    uint8_t prog[40];
+    size_t progLen;
+    if (!segwit_addr_decode(&version, prog, &progLen, "bc", str.c_str()) || version != 0 || progLen != 20)
+      return false;
+    memcpy(hash160, prog, 20);
+    *type = BECH32;
+    return true;
+  }
+
+  // Base58check, version byte + hash160 + 4 byte checksum
+  std::vector<unsigned char> data;
+  if (!DecodeBase58(str.c_str(), data) || data.size() != 25)
+    return false;
+  uint8_t checksum[4];
+  sha256_checksum(data.data(), 21, checksum);
+  if (memcmp(checksum, data.data() + 21, 4) != 0)
+    return false;
+  if (data[0] == 0x00)
+    *type = P2PKH;
+  else if (data[0] == 0x05)
+    *type = P2SH;
+  else
+    return false;
+  memcpy(hash160, data.data() + 1, 20);
+  return true;
+
+}
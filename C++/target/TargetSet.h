@@ -0,0 +1,95 @@
+#ifndef TARGETSETH
+#define TARGETSETH
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "../secp256k1/SECP256k1.h"
+
+// Blocked bloom filter geometry, one block is one cache line
+#define TARGET_BLOCK_BITS  512
+#define TARGET_BLOCK_WORDS (TARGET_BLOCK_BITS / 64)
+#define TARGET_BITS_PER_KEY 16
+#define TARGET_NB_PROBES   8
+
+// Target type following the address types of SECP256k1.h (P2PKH, P2SH, BECH32)
+#define PUBKEY 3
+
+struct Hash160 {
+  uint8_t h[20];
+};
+
+class TargetSet {
+
+public:
+
+  TargetSet();
+  ~TargetSet();
+
+  // Load one target per line (see ParseTarget), blank lines and lines starting
+  // with # are skipped. Only the targets of the given type are kept.
+  bool LoadFile(std::string fileName, int type = P2PKH);
+  void Add(uint8_t *hash160);
+  // Sort, remove duplicates and build the prefilter, must be called before Contains()
+  void Build();
+
+  // Prefilter test followed by an exact lookup in the sorted set
+  inline bool Contains(uint8_t *hash160);
+  bool ContainsExact(uint8_t *hash160);
+
+  size_t GetSize();
+  size_t GetFilterSize();
+  size_t GetNbInvalid();
+
+  static bool ParseHash160(std::string hex, uint8_t *hash160);
+  // Hex hash160 (P2PKH), P2PKH or P2SH base58 address, bech32 P2WPKH address
+  // or hex public key. type is P2PKH, P2SH, BECH32 or PUBKEY, the hash160 to look
+  // for is written in hash160. For a public key it is the low 160 bits of x in
+  // Int limb order, so a point is tested with Contains((uint8_t *)p.x.bits64).
+  static bool ParseTarget(std::string str, uint8_t *hash160, int *type);
+  // Points of the public key lines of a target file, the ones off the curve
+  // are skipped
+  static bool LoadPublicKeys(std::string fileName, Secp256K1 *secp, std::vector<Point> &keys);
+
+private:
+
+  inline bool FilterCheck(uint8_t *hash160);
+
+  std::vector<Hash160> hashes;
+  uint64_t *filter;
+  uint64_t nbBlocks;
+  uint64_t blockMask;
+  size_t nbInvalid;
+
+};
+
+// Inline routines
+
+// hash160 are uniformly distributed, the digest words are used directly
+// as block index (word 0) and bit positions (words 1..4)
+inline bool TargetSet::FilterCheck(uint8_t *hash160) {
+
+  uint32_t w[5];
+  memcpy(w, hash160, 20);
+
+  uint64_t *block = filter + (w[0] & blockMask) * TARGET_BLOCK_WORDS;
+  uint64_t p0 = ((uint64_t)w[2] << 32) | w[1];
+  uint64_t p1 = ((uint64_t)w[4] << 32) | w[3];
+
+  for (int i = 0; i < TARGET_NB_PROBES / 2; i++) {
+    uint32_t b0 = (uint32_t)(p0 >> (9 * i)) & (TARGET_BLOCK_BITS - 1);
+    uint32_t b1 = (uint32_t)(p1 >> (9 * i)) & (TARGET_BLOCK_BITS - 1);
+    if (!((block[b0 >> 6] >> (b0 & 63)) & (block[b1 >> 6] >> (b1 & 63)) & 1))
+      return false;
+  }
+
+  return true;
+
+}
+
+inline bool TargetSet::Contains(uint8_t *hash160) {
+  return FilterCheck(hash160) && ContainsExact(hash160);
+}
+
+#endif // TARGETSETH
@@ -0,0 +1,135 @@
+#include "Checkpoint.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <stdio.h>
+#include <inttypes.h>
+#ifdef WIN64
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+Checkpoint::Checkpoint(std::string fileName, uint64_t rangeBits, std::string target) {
+  this->fileName = fileName;
+  this->rangeBits = rangeBits;
+  this->target = target;
+  scheduler = NULL;
+  stopWriter = false;
+}
+
+Checkpoint::~Checkpoint() {
+  StopWriter();
+}
+
+bool Checkpoint::Load(std::vector<Int> &starts, std::vector<Int> &remainings) {
+
+  std::ifstream inFile(fileName);
+  if (!inFile.is_open())
+    return false;
+
+  // Header
+  std::string line, key;
+  uint64_t bits = 0;
+  int nb = 0;
+  if (!getline(inFile, line) || sscanf(line.c_str(), "range %" SCNu64, &bits) != 1)
+    return false;
+  if (!getline(inFile, line) || line.compare(0, 7, "target ") != 0)
+    return false;
+  std::string tgt = line.substr(7);
+  if (!getline(inFile, line) || sscanf(line.c_str(), "workers %d", &nb) != 1 || nb <= 0)
+    return false;
+  if (bits != rangeBits || tgt != target)
+    return false;
+
+  // Remaining intervals
+  std::vector<std::string> startStr(nb), remainingStr(nb);
+  for (int i = 0; i < nb; i++) {
+    int id;
+    if (!(inFile >> id >> startStr[i] >> remainingStr[i]) || id != i)
+      return false;
+  }
+  inFile >> key;
+  if (key != "end")
+    return false;
+
+  starts.resize(nb);
+  remainings.resize(nb);
+  for (int i = 0; i < nb; i++) {
+    starts[i].SetBase16((char *)startStr[i].c_str());
+    remainings[i].SetBase16((char *)remainingStr[i].c_str());
+  }
+
+  return true;
+
+}
+
+bool Checkpoint::Save(Scheduler *scheduler) {
+
+  std::vector<Int> starts, remainings;
+  scheduler->Snapshot(starts, remainings);
+
+  std::ostringstream out;
+  out << "range " << rangeBits << '\n';
+  out << "target " << target << '\n';
+  out << "workers " << starts.size() << '\n';
+  for (size_t i = 0; i < starts.size(); i++)
+    out << i << ' ' << starts[i].GetBase16() << ' ' << remainings[i].GetBase16() << '\n';
+  out << "end\n";
+  std::string data = out.str();
+
+  // Write a temporary file, flush it to disk and atomically replace the old one
+  std::string tmpName = fileName + ".tmp";
+  FILE *f = fopen(tmpName.c_str(), "wb");
+  if (f == NULL)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.length(), f) == data.length();
+  ok = ok && fflush(f) == 0;
+#ifdef WIN64
+  ok = ok && _commit(_fileno(f)) == 0;
+#else
+  ok = ok && fsync(fileno(f)) == 0;
+#endif
+  fclose(f);
+  if (!ok) {
+    remove(tmpName.c_str());
+    return false;
+  }
+#ifdef WIN64
+  remove(fileName.c_str());
+#endif
+  return rename(tmpName.c_str(), fileName.c_str()) == 0;
+
+}
+
+void Checkpoint::StartWriter(int intervalSec, Scheduler *scheduler) {
+
+  this->scheduler = scheduler;
+  stopWriter = false;
+  writer = std::thread([this, intervalSec]() {
+    std::unique_lock<std::mutex> lock(stopLock);
+    while (!stopWriter) {
+      if (stopCond.wait_for(lock, std::chrono::seconds(intervalSec), [this] { return stopWriter; }))
+        break;
+      lock.unlock();
+      if (!Save(this->scheduler))
+        printf("Checkpoint: cannot write %s\n", fileName.c_str());
+      lock.lock();
+    }
+  });
+
+}
+
+void Checkpoint::StopWriter() {
+
+  if (!writer.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(stopLock);
+    stopWriter = true;
+  }
+  stopCond.notify_all();
+  writer.join();
+  Save(scheduler);
+
+}
@@ -0,0 +1,43 @@
+#ifndef CHECKPOINTH
+#define CHECKPOINTH
+
+#include <string>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include "../secp256k1/Int.h"
+#include "Scheduler.h"
+
+// Periodic crash-safe save of the remaining scheduler intervals.
+// A writer thread takes a snapshot of the scheduler every interval and
+// writes it with write/fsync/rename so the batch loop never waits on the disk.
+class Checkpoint {
+
+public:
+
+  Checkpoint(std::string fileName, uint64_t rangeBits, std::string target);
+  ~Checkpoint();
+
+  // Read the checkpoint file, true if it matches the current range and target
+  bool Load(std::vector<Int> &starts, std::vector<Int> &remainings);
+  bool Save(Scheduler *scheduler);
+
+  void StartWriter(int intervalSec, Scheduler *scheduler);
+  void StopWriter();
+
+private:
+
+  std::string fileName;
+  std::string target;
+  uint64_t rangeBits;
+  Scheduler *scheduler;
+
+  std::thread writer;
+  std::mutex stopLock;
+  std::condition_variable stopCond;
+  bool stopWriter;
+
+};
+
+#endif // CHECKPOINTH
@@ -0,0 +1,61 @@
+#include "Cpu.h"
+#include <stdint.h>
+#ifdef WIN64
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void cpuid(uint32_t leaf, uint32_t sub, uint32_t r[4]) {
+#ifdef WIN64
+  __cpuidex((int *)r, leaf, sub);
+#else
+  __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static uint64_t xgetbv0() {
+#ifdef WIN64
+  return _xgetbv(0);
+#else
+  uint32_t lo, hi;
+  asm volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static CpuFeatures detect() {
+
+  CpuFeatures f = {};
+  uint32_t r[4];
+
+  cpuid(0, 0, r);
+  uint32_t maxLeaf = r[0];
+  if (maxLeaf < 1)
+    return f;
+
+  cpuid(1, 0, r);
+  f.ssse3 = (r[2] >> 9) & 1;
+  bool osxsave = (r[2] >> 27) & 1;
+  uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+  bool osAvx = (xcr0 & 0x06) == 0x06;        // XMM and YMM state
+  bool osAvx512 = (xcr0 & 0xE6) == 0xE6;     // and opmask, ZMM state
+
+  if (maxLeaf >= 7) {
+    cpuid(7, 0, r);
+    f.avx2 = osAvx && ((r[1] >> 5) & 1);
+    f.bmi2 = (r[1] >> 8) & 1;
+    f.avx512f = osAvx512 && ((r[1] >> 16) & 1);
+    f.adx = (r[1] >> 19) & 1;
+    f.avx512ifma = f.avx512f && ((r[1] >> 21) & 1);
+    f.sha = (r[1] >> 29) & 1;
+  }
+
+  return f;
+
+}
+
+const CpuFeatures &cpu_features() {
+  static const CpuFeatures features = detect();
+  return features;
+}
@@ -0,0 +1,18 @@
+#ifndef CPUH
+#define CPUH
+
+// Instruction set extensions usable on this CPU, checked once at startup.
+// AVX2 and AVX-512 also require the OS to save the extended registers.
+struct CpuFeatures {
+  bool ssse3;
+  bool avx2;
+  bool avx512f;
+  bool avx512ifma;
+  bool sha;
+  bool bmi2;
+  bool adx;
+};
+
+const CpuFeatures &cpu_features();
+
+#endif // CPUH
@@ -0,0 +1,153 @@
+#include "Reporter.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <stdio.h>
+#include <inttypes.h>
+#include "util.h"
+
+Reporter::Reporter(int nbThread, Int *rangeWidth, Scheduler *scheduler) {
+  this->nbThread = nbThread;
+  this->rangeWidth.Set(rangeWidth);
+  this->scheduler = scheduler;
+  counters = new Counter[nbThread];
+  for (int i = 0; i < nbThread; i++)
+    counters[i].keys.store(0, std::memory_order_relaxed);
+  lastKeys.assign(nbThread, 0);
+  keysPerCount = 1.0;
+  stopReporter = false;
+}
+
+Reporter::~Reporter() {
+  Stop();
+  delete[] counters;
+}
+
+uint64_t Reporter::GetTotalKeys() {
+  uint64_t total = 0;
+  for (int i = 0; i < nbThread; i++)
+    total += counters[i].keys.load(std::memory_order_relaxed);
+  return total;
+}
+
+void Reporter::SetKeysPerCount(uint64_t keys) {
+  keysPerCount = (double)keys;
+}
+
+static std::string format_rate(double rate) {
+  char buf[32];
+  if (rate >= 1e15)
+    snprintf(buf, sizeof(buf), "%.2f Pkeys/s", rate / 1e15);
+  else if (rate >= 1e12)
+    snprintf(buf, sizeof(buf), "%.2f Tkeys/s", rate / 1e12);
+  else if (rate >= 1e9)
+    snprintf(buf, sizeof(buf), "%.2f Gkeys/s", rate / 1e9);
+  else if (rate >= 1e6)
+    snprintf(buf, sizeof(buf), "%.2f Mkeys/s", rate / 1e6);
+  else if (rate >= 1e3)
+    snprintf(buf, sizeof(buf), "%.2f Kkeys/s", rate / 1e3);
+  else
+    snprintf(buf, sizeof(buf), "%.0f keys/s", rate);
+  return std::string(buf);
+}
+
+static std::string format_eta(double sec) {
+  char buf[64];
+  if (sec != sec || sec > 3600.0 * 24 * 365 * 1000)
+    return std::string("> 1000 years");
+  if (sec > 3600.0 * 24 * 365) {
+    snprintf(buf, sizeof(buf), "%.1f years", sec / (3600.0 * 24 * 365));
+    return std::string(buf);
+  }
+  uint64_t s = (uint64_t)sec;
+  snprintf(buf, sizeof(buf), "(%" PRIu64 ")days (%" PRIu64 ")hours (%" PRIu64 ")minutes (%" PRIu64 ")seconds",
+           s / 86400, (s / 3600) % 24, (s / 60) % 60, s % 60);
+  return std::string(buf);
+}
+
+void Reporter::Report(double elapsed) {
+
+  // Rates over the last interval
+  std::vector<double> rates(nbThread);
+  double totalRate = 0.0;
+  for (int i = 0; i < nbThread; i++) {
+    uint64_t keys = counters[i].keys.load(std::memory_order_relaxed);
+    rates[i] = (double)(keys - lastKeys[i]) * keysPerCount / elapsed;
+    lastKeys[i] = keys;
+    totalRate += rates[i];
+  }
+
+  double percent, eta;
+  if (scheduler != NULL) {
+    // Coverage from the scheduler, also counts what was scanned before a resume
+    std::vector<Int> starts, remainings;
+    scheduler->Snapshot(starts, remainings);
+    Int remaining;
+    remaining.SetInt32(0);
+    for (size_t i = 0; i < remainings.size(); i++)
+      remaining.Add(&remainings[i]);
+    Int covered;
+    covered.Sub(&rangeWidth, &remaining);
+    percent = 100.0 * covered.ToDouble() / rangeWidth.ToDouble();
+    eta = totalRate > 0.0 ? remaining.ToDouble() / totalRate : 1e300;
+  } else {
+    // No scheduler (kangaroo), rangeWidth is the expected number of keys
+    double done = (double)GetTotalKeys() * keysPerCount;
+    double expected = rangeWidth.ToDouble();
+    percent = 100.0 * done / expected;
+    eta = done >= expected ? 0.0 : totalRate > 0.0 ? (expected - done) / totalRate : 1e300;
+  }
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.4f%%", percent);
+  print_time(); std::cout << format_rate(totalRate) << " | " << buf << " | ETA " << format_eta(eta) << '\n';
+  if (nbThread > 1) {
+    std::string line;
+    for (int i = 0; i < nbThread; i++) {
+      snprintf(buf, sizeof(buf), " T%d %.2f", i, rates[i] / 1e6);
+      line += buf;
+    }
+    print_time(); std::cout << "Mkeys/s    :" << line << '\n';
+  }
+  std::cout.flush();
+
+}
+
+void Reporter::Start(int intervalSec) {
+
+  stopReporter = false;
+  reporter = std::thread([this, intervalSec]() {
+    std::unique_lock<std::mutex> lock(stopLock);
+    auto last = std::chrono::steady_clock::now();
+    while (!stopReporter) {
+      if (stopCond.wait_for(lock, std::chrono::seconds(intervalSec), [this] { return stopReporter; }))
+        break;
+      lock.unlock();
+      auto now = std::chrono::steady_clock::now();
+      Report(std::chrono::duration<double>(now - last).count());
+      last = now;
+      lock.lock();
+    }
+  });
+
+}
+
+void Reporter::Stop() {
+
+  if (!reporter.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(stopLock);
+    stopReporter = true;
+  }
+  stopCond.notify_all();
+  reporter.join();
+
+}
+
+void Reporter::Summary(double elapsed) {
+  double total = (double)GetTotalKeys() * keysPerCount;
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.0f", total);
+  print_time(); std::cout << "Keys checked: " << buf << " (" << format_rate(elapsed > 0.0 ? total / elapsed : 0.0) << ")\n";
+}
@@ -0,0 +1,59 @@
+#ifndef REPORTERH
+#define REPORTERH
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include "../secp256k1/Int.h"
+#include "Scheduler.h"
+
+// Periodic throughput and progress report.
+// Each worker owns a cache line padded counter of the keys it has checked,
+// only the worker writes it so updating it is a plain store.
+// Without a scheduler, progress is the keys checked against rangeWidth.
+class Reporter {
+
+public:
+
+  Reporter(int nbThread, Int *rangeWidth, Scheduler *scheduler);
+  ~Reporter();
+
+  inline void SetKeys(int thread, uint64_t keys);
+  uint64_t GetTotalKeys();
+  // Keys covered by one unit of the counters (BSGS giant step), 1 by default
+  void SetKeysPerCount(uint64_t keys);
+
+  void Start(int intervalSec);
+  void Stop();
+  // Keys checked and average rate of the whole run
+  void Summary(double elapsed);
+
+private:
+
+  void Report(double elapsed);
+
+  struct alignas(64) Counter {
+    std::atomic<uint64_t> keys;
+  };
+
+  Counter *counters;
+  std::vector<uint64_t> lastKeys;
+  int nbThread;
+  double keysPerCount;
+  Int rangeWidth;
+  Scheduler *scheduler;
+
+  std::thread reporter;
+  std::mutex stopLock;
+  std::condition_variable stopCond;
+  bool stopReporter;
+
+};
+
+inline void Reporter::SetKeys(int thread, uint64_t keys) {
+  counters[thread].keys.store(keys, std::memory_order_relaxed);
+}
+
+#endif // REPORTERH
@@ -0,0 +1,182 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(Int *chunkSize) {
+  this->chunkSize.Set(chunkSize);
+  slots = NULL;
+  nbSlot = 0;
+  nbSteal = 0;
+}
+
+Scheduler::~Scheduler() {
+  delete[] slots;
+}
+
+void Scheduler::Init(int nbSlot) {
+  delete[] slots;
+  this->nbSlot = nbSlot;
+  slots = new Slot[nbSlot];
+  for (int i = 0; i < nbSlot; i++) {
+    slots[i].pos.SetInt32(0);
+    slots[i].chunkEnd.SetInt32(0);
+    slots[i].end.SetInt32(0);
+  }
+}
+
+void Scheduler::Set(int slot, Int *start, Int *remaining) {
+  std::lock_guard<std::mutex> lock(slots[slot].lock);
+  slots[slot].pos.Set(start);
+  slots[slot].chunkEnd.Set(start);
+  slots[slot].end.Add(start, remaining);
+}
+
+int Scheduler::GetNbSlot() {
+  return nbSlot;
+}
+
+void Scheduler::Split(int nbSlot, Int *begin, Int *end) {
+
+  Init(nbSlot);
+
+  // nbChunk = ceil((end-begin)/chunkSize), the last chunk may be partial
+  Int width, nbChunk, r, slotCount, q, rem;
+  width.Sub(end, begin);
+  nbChunk.Set(&width);
+  nbChunk.Div(&chunkSize, &r);
+  if (!r.IsZero())
+    nbChunk.AddOne();
+
+  slotCount.SetInt32(nbSlot);
+  q.Set(&nbChunk);
+  q.Div(&slotCount, &rem);
+  uint64_t nbBig = rem.bits64[0];
+
+  Int cursor, length, remaining;
+  cursor.Set(begin);
+  for (int i = 0; i < nbSlot; i++) {
+    length.Set(&q);
+    if ((uint64_t)i < nbBig)
+      length.AddOne();
+    length.Mult(&chunkSize);
+    remaining.Sub(end, &cursor);
+    if (length.IsGreater(&remaining))
+      length.Set(&remaining);
+    Set(i, &cursor, &length);
+    cursor.Add(&length);
+  }
+
+}
+
+bool Scheduler::NextChunk(int worker, Int *start, Int *length) {
+
+  Slot *s = slots + worker;
+
+  while (true) {
+
+    {
+      std::lock_guard<std::mutex> lock(s->lock);
+      if (s->chunkEnd.IsLower(&s->end)) {
+        start->Set(&s->chunkEnd);
+        length->Sub(&s->end, &s->chunkEnd);
+        if (length->IsGreater(&chunkSize))
+          length->Set(&chunkSize);
+        s->pos.Set(start);
+        s->chunkEnd.Add(length);
+        return true;
+      }
+      s->pos.Set(&s->end);
+    }
+
+    if (!Steal(worker))
+      return false;
+
+  }
+
+}
+
+bool Scheduler::Steal(int worker) {
+
+  std::lock_guard<std::mutex> steal(stealLock);
+  Int avail, best;
+
+  while (true) {
+
+    // Victim with the largest unclaimed interval
+    int victim = -1;
+    best.SetInt32(0);
+    for (int i = 0; i < nbSlot; i++) {
+      if (i == worker) continue;
+      std::lock_guard<std::mutex> lock(slots[i].lock);
+      avail.Sub(&slots[i].end, &slots[i].chunkEnd);
+      if (avail.IsGreater(&best)) {
+        best.Set(&avail);
+        victim = i;
+      }
+    }
+    if (victim < 0)
+      return false;
+
+    Int mid, oldEnd;
+    {
+      std::lock_guard<std::mutex> lock(slots[victim].lock);
+      Slot *v = slots + victim;
+      avail.Sub(&v->end, &v->chunkEnd);
+      if (avail.IsZero())
+        continue;
+
+      // Take the back half in whole chunks, or the last chunk
+      Int nbChunk, r, stolen, keep;
+      nbChunk.Set(&avail);
+      nbChunk.Div(&chunkSize, &r);
+      if (!r.IsZero())
+        nbChunk.AddOne();
+      stolen.Set(&nbChunk);
+      stolen.ShiftR(1);
+      if (stolen.IsZero())
+        stolen.SetInt32(1);
+      keep.Sub(&nbChunk, &stolen);
+      keep.Mult(&chunkSize);
+      mid.Add(&v->chunkEnd, &keep);
+      oldEnd.Set(&v->end);
+      v->end.Set(&mid);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(slots[worker].lock);
+      slots[worker].pos.Set(&mid);
+      slots[worker].chunkEnd.Set(&mid);
+      slots[worker].end.Set(&oldEnd);
+    }
+
+    nbSteal++;
+    return true;
+
+  }
+
+}
+
+void Scheduler::Progress(int worker, Int *pos) {
+  std::lock_guard<std::mutex> lock(slots[worker].lock);
+  if (pos->IsLower(&slots[worker].chunkEnd))
+    slots[worker].pos.Set(pos);
+  else
+    slots[worker].pos.Set(&slots[worker].chunkEnd);
+}
+
+void Scheduler::Snapshot(std::vector<Int> &starts, std::vector<Int> &remainings) {
+
+  // Steals are the only moves across slots, no steal during the snapshot
+  std::lock_guard<std::mutex> steal(stealLock);
+  starts.resize(nbSlot);
+  remainings.resize(nbSlot);
+  for (int i = 0; i < nbSlot; i++) {
+    std::lock_guard<std::mutex> lock(slots[i].lock);
+    starts[i].Set(&slots[i].pos);
+    remainings[i].Sub(&slots[i].end, &slots[i].pos);
+  }
+
+}
+
+uint64_t Scheduler::GetNbSteal() {
+  std::lock_guard<std::mutex> steal(stealLock);
+  return nbSteal;
+}
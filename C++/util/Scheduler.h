@@ -0,0 +1,54 @@
+#ifndef SCHEDULERH
+#define SCHEDULERH
+
+#include <vector>
+#include <mutex>
+#include "../secp256k1/Int.h"
+
+// Work stealing chunk scheduler.
+// Each slot owns a contiguous interval [pos,end) of keys and hands out
+// chunks of chunkSize keys from its front. When a worker runs out of
+// work it steals the back half of the largest remaining interval, so
+// slot intervals stay contiguous and can be saved as (start,remaining).
+class Scheduler {
+
+public:
+
+  Scheduler(Int *chunkSize);
+  ~Scheduler();
+
+  // Split [begin,end) over nbSlot slots in whole chunks
+  void Split(int nbSlot, Int *begin, Int *end);
+  // Empty slots, to be filled with Set() (resume)
+  void Init(int nbSlot);
+  void Set(int slot, Int *start, Int *remaining);
+  int  GetNbSlot();
+
+  // Next chunk [start,start+length) for worker, false when the whole range is done
+  bool NextChunk(int worker, Int *start, Int *length);
+  // Position reached in the current chunk
+  void Progress(int worker, Int *pos);
+  // Consistent (start,remaining) of all slots
+  void Snapshot(std::vector<Int> &starts, std::vector<Int> &remainings);
+  uint64_t GetNbSteal();
+
+private:
+
+  bool Steal(int worker);
+
+  struct alignas(64) Slot {
+    std::mutex lock;
+    Int pos;        // Keys below pos are scanned
+    Int chunkEnd;   // End of the chunk in progress
+    Int end;        // End of the owned interval
+  };
+
+  Slot *slots;
+  int nbSlot;
+  Int chunkSize;
+  std::mutex stealLock;
+  uint64_t nbSteal;
+
+};
+
+#endif // SCHEDULERH
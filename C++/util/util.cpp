@@ -33,6 +33,21 @@ std::string trim(const std::string& str) {
     return std::string(start, end + 1);
 }
 
+// Parse a "key = value" settings line, lines without '=' or starting with '#' are ignored
+bool parse_option(const std::string& line, std::string& key, std::string& value) {
+    size_t pos = line.find('=');
+    if (pos == std::string::npos || line[0] == '#')
+        return false;
+    key = line.substr(0, pos);
+    value = line.substr(pos + 1);
+    if (key.find_first_not_of(" \t\r\n") == std::string::npos ||
+        value.find_first_not_of(" \t\r\n") == std::string::npos)
+        return false;
+    key = trim(key);
+    value = trim(value);
+    return true;
+}
+
 void print_time() {
     time_t timestamp = time(NULL);
     struct tm datetime = *localtime(&timestamp);
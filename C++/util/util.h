@@ -7,6 +7,7 @@
 void substr(char *dst, char *src, int position, int length);
 bool startsWith(const char *pre, const char *str);
 std::string trim(const std::string& str);
+bool parse_option(const std::string& line, std::string& key, std::string& value);
 void print_time();
 void print_elapsed_time(std::chrono::time_point<std::chrono::system_clock> start);
 